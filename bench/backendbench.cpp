@@ -0,0 +1,226 @@
+#include "backendbench.h"
+#include "noteformatter.h"
+#include "ratingsmerger.h"
+#include "ratingsmodel.h"
+#include "ratingsstore.h"
+#include "seventeenlandsparser.h"
+#include "seventeenlandsstats.h"
+#include "seventeentable.h"
+#include "syntheticpayloads.h"
+#include "uploadengine.h"
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QSortFilterProxyModel>
+#include <QTest>
+#include <numeric>
+namespace {
+// the reply is fed to the parser in the pieces a network read would typically deliver
+const int chunkSize = 16 * 1024;
+
+SeventeenTable parseSeventeenLandsPayload(const QByteArray &payload)
+{
+    SeventeenTable result;
+    SeventeenLandsParser parser([&result](const SeventeenCard &card) { result.append(card); });
+    for (int i = 0; i < payload.size(); i += chunkSize)
+        parser.addData(payload.mid(i, chunkSize));
+    return result;
+}
+
+QStringList metricCodes()
+{
+    QStringList result;
+    for (int i = 0; i < SLCount; ++i)
+        result.append(QCoreApplication::translate("SLMetrics", slMetricDescriptors[i].code));
+    return result;
+}
+
+quint32 defaultNoteMetrics()
+{
+    quint32 result = 0;
+    for (int i = 0; i < SLCount; ++i) {
+        if (slMetricDescriptors[i].inDefaultNote)
+            result |= slMetricBit(i);
+    }
+    return result;
+}
+}
+
+void BackendBench::addSizeRows()
+{
+    QTest::addColumn<int>("cards");
+    for (int cards : {300, 3000, 30000})
+        QTest::newRow(qPrintable(QString::number(cards))) << cards;
+}
+
+void BackendBench::parseSeventeenLands_data()
+{
+    addSizeRows();
+}
+
+void BackendBench::parseSeventeenLands()
+{
+    QFETCH(int, cards);
+    const QByteArray payload = SyntheticPayloads::seventeenLands(cards);
+    QCOMPARE(parseSeventeenLandsPayload(payload).size(), cards);
+    QBENCHMARK {
+        parseSeventeenLandsPayload(payload);
+    }
+}
+
+void BackendBench::ingestTemplate_data()
+{
+    addSizeRows();
+}
+
+void BackendBench::ingestTemplate()
+{
+    QFETCH(int, cards);
+    const QByteArray payload = SyntheticPayloads::mtgahTemplate(cards);
+    QCOMPARE(RatingsStore::fromMtgahTemplate(payload).size(), cards);
+    QBENCHMARK {
+        RatingsStore::fromMtgahTemplate(payload);
+    }
+}
+
+void BackendBench::mergeRatings_data()
+{
+    addSizeRows();
+}
+
+void BackendBench::mergeRatings()
+{
+    QFETCH(int, cards);
+    const SeventeenTable ratings = parseSeventeenLandsPayload(SyntheticPayloads::seventeenLands(cards));
+    RatingsModel model;
+    model.setRatingsTemplate(RatingsStore::fromMtgahTemplate(SyntheticPayloads::mtgahTemplate(cards)));
+    const NoteFormatter noteFormatter(QLocale(), metricCodes(), defaultNoteMetrics());
+    QBENCHMARK {
+        const QVector<RatingUpdate> updates = RatingsMerger::merge(
+                model.ratingsTemplate(), SyntheticPayloads::setCode(), ratings, SLever_drawn_win_rate,
+                [&noteFormatter](const SeventeenTable &table, int row) -> QString { return noteFormatter.format(table, row); });
+        model.applyUpdates(updates);
+    }
+}
+
+void BackendBench::rerateRatings_data()
+{
+    QTest::addColumn<int>("cards");
+    QTest::addColumn<int>("normalization");
+    const char *const names[] = {"linear", "percentile", "zscore", "shrunk"};
+    for (int cards : {300, 3000, 30000}) {
+        for (int i = 0; i < SeventeenTable::NormalizationCount; ++i)
+            QTest::addRow("%d %s", cards, names[i]) << cards << i;
+    }
+}
+
+// what changing the rating metric costs once the statistics are in memory
+void BackendBench::rerateRatings()
+{
+    QFETCH(int, cards);
+    QFETCH(int, normalization);
+    const SeventeenTable ratings = parseSeventeenLandsPayload(SyntheticPayloads::seventeenLands(cards));
+    const RatingsStore ratingsTemplate = RatingsStore::fromMtgahTemplate(SyntheticPayloads::mtgahTemplate(cards));
+    QVector<int> rows(ratingsTemplate.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    QBENCHMARK {
+        SeventeenLandsStats stats;
+        stats.insert(SyntheticPayloads::setCode(), ratings);
+        const QVector<RatingUpdate> updates =
+                RatingsMerger::rerate(ratingsTemplate, rows, stats, SLever_drawn_win_rate, static_cast<SeventeenTable::Normalization>(normalization),
+                                      RatingsMerger::RatingPart, RatingsMerger::NoteFunction());
+        QCOMPARE(updates.size(), cards);
+    }
+}
+
+void BackendBench::formatNotes_data()
+{
+    addSizeRows();
+}
+
+void BackendBench::formatNotes()
+{
+    QFETCH(int, cards);
+    const SeventeenTable ratings = parseSeventeenLandsPayload(SyntheticPayloads::seventeenLands(cards));
+    const QStringList codes = metricCodes();
+    const quint32 noteMetrics = defaultNoteMetrics();
+    QBENCHMARK {
+        const NoteFormatter noteFormatter(QLocale(), codes, noteMetrics);
+        for (int i = 0, iEnd = ratings.size(); i < iEnd; ++i)
+            noteFormatter.format(ratings, i);
+    }
+}
+
+void BackendBench::uploadBodies_data()
+{
+    addSizeRows();
+}
+
+void BackendBench::uploadBodies()
+{
+    QFETCH(int, cards);
+    const QVector<MtgahCard> uploads =
+            RatingsStore::fromMtgahTemplate(SyntheticPayloads::mtgahTemplate(cards)).cards(QStringList(SyntheticPayloads::setCode()));
+    QByteArray buffer;
+    for (const MtgahCard &card : uploads) {
+        buffer.resize(0);
+        UploadEngine::appendBody(buffer, card);
+        QJsonObject expected;
+        expected[QLatin1String("idArena")] = card.id_arena;
+        expected[QLatin1String("note")] = card.note.isEmpty() ? QJsonValue() : QJsonValue(card.note);
+        expected[QLatin1String("rating")] = card.rating < 0 ? QJsonValue() : QJsonValue(int(card.rating));
+        QCOMPARE(QJsonDocument::fromJson(buffer).object(), expected);
+    }
+    QBENCHMARK {
+        for (const MtgahCard &card : uploads) {
+            buffer.resize(0);
+            UploadEngine::appendBody(buffer, card);
+        }
+    }
+}
+
+void BackendBench::modelSweep_data()
+{
+    addSizeRows();
+}
+
+void BackendBench::modelSweep()
+{
+    QFETCH(int, cards);
+    RatingsModel model;
+    model.setRatingsTemplate(RatingsStore::fromMtgahTemplate(SyntheticPayloads::mtgahTemplate(cards)));
+    QCOMPARE(model.rowCount(), cards);
+    QBENCHMARK {
+        for (int i = 0, iEnd = model.rowCount(); i < iEnd; ++i) {
+            for (int j = 0, jEnd = model.columnCount(); j < jEnd; ++j) {
+                const QModelIndex idx = model.index(i, j);
+                for (int role : {int(Qt::DisplayRole), int(Qt::EditRole), int(RatingsModel::DirtyRole)})
+                    model.data(idx, role);
+            }
+        }
+    }
+}
+
+void BackendBench::sortByName_data()
+{
+    addSizeRows();
+}
+
+// a rating edit while the view is sorted by name, as the ratings view does it
+void BackendBench::sortByName()
+{
+    QFETCH(int, cards);
+    RatingsModel model;
+    model.setRatingsTemplate(RatingsStore::fromMtgahTemplate(SyntheticPayloads::mtgahTemplate(cards)));
+    QSortFilterProxyModel proxy;
+    proxy.setSortRole(RatingsModel::SortRole);
+    proxy.setSourceModel(&model);
+    int rating = 0;
+    QBENCHMARK {
+        proxy.sort(RatingsModel::rmcName);
+        model.setData(model.index(cards / 2, RatingsModel::rmcRating), rating);
+        rating = (rating + 1) % 11;
+        proxy.sort(-1);
+    }
+}
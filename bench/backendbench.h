@@ -0,0 +1,43 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef BACKENDBENCH_H
+#define BACKENDBENCH_H
+#include <QObject>
+class BackendBench : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void parseSeventeenLands_data();
+    void parseSeventeenLands();
+    void ingestTemplate_data();
+    void ingestTemplate();
+    void mergeRatings_data();
+    void mergeRatings();
+    void rerateRatings_data();
+    void rerateRatings();
+    void formatNotes_data();
+    void formatNotes();
+    void uploadBodies_data();
+    void uploadBodies();
+    void modelSweep_data();
+    void modelSweep();
+    void sortByName_data();
+    void sortByName();
+
+private:
+    void addSizeRows();
+};
+
+#endif
@@ -0,0 +1,32 @@
+#include "backendbench.h"
+#include "noteformatterbench.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QTest>
+// -resultsdir <dir> writes the results of every bench class to <dir>/<class>.xml
+// so runs of different versions can be compared
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList arguments = app.arguments();
+    QString resultsDir;
+    const int resultsDirIndex = arguments.indexOf(QStringLiteral("-resultsdir"));
+    if (resultsDirIndex > 0 && resultsDirIndex + 1 < arguments.size()) {
+        resultsDir = arguments.at(resultsDirIndex + 1);
+        arguments.erase(arguments.begin() + resultsDirIndex, arguments.begin() + resultsDirIndex + 2);
+        QDir().mkpath(resultsDir);
+    }
+    NoteFormatterBench noteFormatterBench;
+    BackendBench backendBench;
+    int result = 0;
+    for (QObject *bench : std::initializer_list<QObject *>{&noteFormatterBench, &backendBench}) {
+        QStringList benchArguments = arguments;
+        if (!resultsDir.isEmpty()) {
+            const QString resultsFile = QDir(resultsDir).filePath(QLatin1String(bench->metaObject()->className()) + QLatin1String(".xml"));
+            benchArguments << QStringLiteral("-o") << resultsFile + QLatin1String(",xml");
+            benchArguments << QStringLiteral("-o") << QStringLiteral("-,txt");
+        }
+        result |= QTest::qExec(bench, benchArguments);
+    }
+    return result;
+}
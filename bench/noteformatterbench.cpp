@@ -0,0 +1,116 @@
+#include "noteformatterbench.h"
+#include "noteformatter.h"
+#include <QCoreApplication>
+#include <QLocale>
+#include <QRandomGenerator>
+#include <QTest>
+namespace {
+const int benchCards = 3000;
+
+quint32 noteMetrics(bool defaultOnly)
+{
+    quint32 result = 0;
+    for (int i = 0; i < SLCount; ++i) {
+        if (!defaultOnly || slMetricDescriptors[i].inDefaultNote)
+            result |= slMetricBit(i);
+    }
+    return result;
+}
+
+// the implementation NoteFormatter replaced, kept as reference for output and speed
+QString legacyCommentString(const QLocale &currentLocale, const QStringList &codes, const SeventeenTable &table, int row, quint32 noteMetrics)
+{
+    QStringList result;
+    for (int i = 0; i < SLCount; ++i) {
+        if (!(noteMetrics & slMetricBit(i)))
+            continue;
+        const SLMetricDescriptor &descriptor = slMetricDescriptors[i];
+        if (descriptor.type == SLIntegerMetric)
+            result.append(codes.at(i) + QLatin1Char(':') + currentLocale.toString(table.intValue(i, row)));
+        else if (descriptor.percent)
+            result.append(codes.at(i) + QLatin1Char(':') + currentLocale.toString(table.doubleValue(i, row) * 100.0, 'f', descriptor.precision)
+                          + currentLocale.percent());
+        else
+            result.append(codes.at(i) + QLatin1Char(':') + currentLocale.toString(table.doubleValue(i, row), 'f', descriptor.precision));
+    }
+    return result.join(QLatin1Char(' '));
+}
+}
+
+void NoteFormatterBench::initTestCase()
+{
+    QRandomGenerator generator(17);
+    m_table.reserve(benchCards);
+    for (int i = 0; i < benchCards; ++i) {
+        SeventeenCard card;
+        card.name = QLatin1String("Card ") + QString::number(i);
+        for (int j = 0; j < SLCount; ++j) {
+            if (slMetricIsInteger(j))
+                card.metrics[j] = generator.bounded(200000);
+            else if (slMetricDescriptors[j].percent)
+                card.metrics[j] = generator.bounded(1.0) - (j == SLdrawn_improvement_win_rate ? 0.5 : 0.0);
+            else
+                card.metrics[j] = 1.0 + generator.bounded(14.0);
+        }
+        m_table.append(card);
+    }
+    for (int i = 0; i < SLCount; ++i)
+        m_codes.append(QCoreApplication::translate("SLMetrics", slMetricDescriptors[i].code));
+}
+
+void NoteFormatterBench::addFormatRows()
+{
+    QTest::addColumn<QLocale>("locale");
+    QTest::addColumn<quint32>("noteMetrics");
+    const QStringList localeNames{QStringLiteral("C"), QStringLiteral("en_US"), QStringLiteral("de_DE"), QStringLiteral("fr_FR"),
+                                  QStringLiteral("ar_EG")};
+    for (const QString &localeName : localeNames) {
+        QTest::newRow(qPrintable(localeName + QLatin1String(" default"))) << QLocale(localeName) << noteMetrics(true);
+        QTest::newRow(qPrintable(localeName + QLatin1String(" all"))) << QLocale(localeName) << noteMetrics(false);
+    }
+}
+
+void NoteFormatterBench::sameOutput_data()
+{
+    addFormatRows();
+}
+
+void NoteFormatterBench::sameOutput()
+{
+    QFETCH(QLocale, locale);
+    QFETCH(quint32, noteMetrics);
+    const NoteFormatter formatter(locale, m_codes, noteMetrics);
+    for (int i = 0, iEnd = m_table.size(); i < iEnd; ++i)
+        QCOMPARE(formatter.format(m_table, i), legacyCommentString(locale, m_codes, m_table, i, noteMetrics));
+}
+
+void NoteFormatterBench::legacyFormat_data()
+{
+    addFormatRows();
+}
+
+void NoteFormatterBench::legacyFormat()
+{
+    QFETCH(QLocale, locale);
+    QFETCH(quint32, noteMetrics);
+    QBENCHMARK {
+        for (int i = 0, iEnd = m_table.size(); i < iEnd; ++i)
+            legacyCommentString(locale, m_codes, m_table, i, noteMetrics);
+    }
+}
+
+void NoteFormatterBench::noteFormatter_data()
+{
+    addFormatRows();
+}
+
+void NoteFormatterBench::noteFormatter()
+{
+    QFETCH(QLocale, locale);
+    QFETCH(quint32, noteMetrics);
+    QBENCHMARK {
+        const NoteFormatter formatter(locale, m_codes, noteMetrics);
+        for (int i = 0, iEnd = m_table.size(); i < iEnd; ++i)
+            formatter.format(m_table, i);
+    }
+}
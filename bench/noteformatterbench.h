@@ -0,0 +1,38 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef NOTEFORMATTERBENCH_H
+#define NOTEFORMATTERBENCH_H
+#include "seventeentable.h"
+#include <QObject>
+#include <QStringList>
+class NoteFormatterBench : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void sameOutput_data();
+    void sameOutput();
+    void legacyFormat_data();
+    void legacyFormat();
+    void noteFormatter_data();
+    void noteFormatter();
+
+private:
+    void addFormatRows();
+    SeventeenTable m_table;
+    QStringList m_codes;
+};
+
+#endif
@@ -0,0 +1,67 @@
+#include "syntheticpayloads.h"
+#include "slmetrics.h"
+#include <QRandomGenerator>
+
+QString SyntheticPayloads::setCode()
+{
+    return QStringLiteral("BEN");
+}
+
+QString SyntheticPayloads::cardName(int index)
+{
+    return QLatin1String("Synthetic Card ") + QString::number(index);
+}
+
+QByteArray SyntheticPayloads::seventeenLands(int cards)
+{
+    QRandomGenerator generator(17);
+    QByteArray result;
+    result.reserve(cards * 800);
+    result.append('[');
+    for (int i = 0; i < cards; ++i) {
+        if (i > 0)
+            result.append(", ");
+        result.append("{\"name\": \"");
+        result.append(cardName(i).toUtf8());
+        result.append("\", \"color\": \"W\", \"rarity\": \"common\"");
+        for (int j = 0; j < SLCount; ++j) {
+            result.append(", \"");
+            result.append(slMetricDescriptors[j].jsonKey);
+            result.append("\": ");
+            if (slMetricIsInteger(j))
+                result.append(QByteArray::number(generator.bounded(200000)));
+            else if (slMetricDescriptors[j].percent)
+                result.append(QByteArray::number(generator.bounded(1.0) - (j == SLdrawn_improvement_win_rate ? 0.5 : 0.0), 'g', 17));
+            else
+                result.append(QByteArray::number(1.0 + generator.bounded(14.0), 'g', 17));
+        }
+        result.append(", \"url\": \"https://cards.scryfall.io/large/front/synthetic.jpg\"}");
+    }
+    result.append(']');
+    return result;
+}
+
+QByteArray SyntheticPayloads::mtgahTemplate(int cards)
+{
+    QRandomGenerator generator(42);
+    QByteArray result;
+    result.reserve(cards * 200);
+    result.append('[');
+    for (int i = 0; i < cards; ++i) {
+        if (i > 0)
+            result.append(',');
+        result.append("{\"card\":{\"idArena\":");
+        result.append(QByteArray::number(70000 + i));
+        result.append(",\"set\":\"");
+        result.append(setCode().toUtf8());
+        result.append("\",\"name\":\"");
+        result.append(cardName(i).toUtf8());
+        result.append("\"},\"rating\":");
+        result.append(i % 4 == 0 ? QByteArray("null") : QByteArray::number(generator.bounded(11)));
+        result.append(",\"note\":");
+        result.append(i % 3 == 0 ? QByteArray("null") : QByteArray("\"ATA:3.20 GIH WR:55.10%\""));
+        result.append('}');
+    }
+    result.append(']');
+    return result;
+}
@@ -0,0 +1,28 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef SYNTHETICPAYLOADS_H
+#define SYNTHETICPAYLOADS_H
+#include <QByteArray>
+#include <QString>
+// Deterministic stand-ins for the server replies, every card of the set appears in both payloads
+namespace SyntheticPayloads {
+QString setCode();
+QString cardName(int index);
+// card_ratings reply of 17Lands
+QByteArray seventeenLands(int cards);
+// customDraftRatingsForDisplay reply of MTGAHelper
+QByteArray mtgahTemplate(int cards);
+}
+#endif
@@ -0,0 +1,252 @@
+#include "batchrun.h"
+#include "noteformatter.h"
+#include "ratingsmerger.h"
+#include "stringpool.h"
+#include "worker.h"
+#include <QCoreApplication>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+namespace {
+double perSecond(qint64 count, qint64 msecs)
+{
+    return msecs > 0 ? count * 1000.0 / msecs : 0.0;
+}
+}
+
+BatchOptions::BatchOptions()
+    : format(QStringLiteral("PremierDraft"))
+    , ratingMetric(SLdrawn_win_rate)
+    , normalization(SeventeenTable::MinMaxNormalization)
+    , noteMetrics(0)
+    , dryRun(false)
+    , cube(false)
+    , blendFormats(false)
+    , uploadWindow(16)
+{
+    for (int i = 0; i < SLCount; ++i) {
+        if (slMetricDescriptors[i].inDefaultNote)
+            noteMetrics |= slMetricBit(i);
+    }
+}
+
+BatchRun::BatchRun(const BatchOptions &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_worker(new Worker(this))
+    , m_noteFormatter(nullptr)
+    , m_phase(LoginPhase)
+    , m_setsCompleted(0)
+    , m_setsFailed(0)
+    , m_slicesFailed(0)
+    , m_seventeenLandsCards(0)
+    , m_mergedCards(0)
+    , m_cardsToUpload(0)
+    , m_cardsUploaded(0)
+    , m_uploadsFailed(0)
+    , m_uploadRate(0.0)
+{
+    std::fill(std::begin(m_phaseTimes), std::end(m_phaseTimes), 0);
+    QStringList codes;
+    for (int i = 0; i < SLCount; ++i)
+        codes.append(QCoreApplication::translate("SLMetrics", slMetricDescriptors[i].code));
+    m_noteFormatter = new NoteFormatter(m_options.locale, codes, m_options.noteMetrics);
+    connect(m_worker, &Worker::loggedIn, this, &BatchRun::onLoggedIn);
+    connect(m_worker, &Worker::loginFalied, this, std::bind(&BatchRun::finish, this, LoginFailed));
+    connect(m_worker, &Worker::customRatingTemplate, this, &BatchRun::onTemplate);
+    connect(m_worker, &Worker::customRatingTemplateFailed, this, std::bind(&BatchRun::finish, this, TemplateFailed));
+    connect(m_worker, &Worker::downloaded17LRatings, this, &BatchRun::onRatings);
+    connect(m_worker, &Worker::failed17LRatings, this, &BatchRun::onRatingsFailed);
+    connect(m_worker, &Worker::downloaded17LSlice, this, &BatchRun::onSlice);
+    connect(m_worker, &Worker::failed17LSlice, this, [this]() { ++m_slicesFailed; });
+    connect(m_worker, &Worker::downloadedAll17LCube, this, &BatchRun::onCubeDownloaded);
+    connect(m_worker, &Worker::ratingUploaded, this, std::bind(&BatchRun::onCardUploaded, this, true));
+    connect(m_worker, &Worker::failedUploadRating, this, std::bind(&BatchRun::onCardUploaded, this, false));
+    // includes what an interrupted run left in the upload journal
+    connect(m_worker, &Worker::ratingsUploadMaxProgress, this, [this](int progress) { m_cardsToUpload = progress; });
+    connect(m_worker, &Worker::setRatingsUploaded, this, &BatchRun::onSetUploaded);
+    connect(m_worker, &Worker::ratingsUploadRate, this, [this](double cardsPerSecond) { m_uploadRate = cardsPerSecond; });
+    connect(m_worker, &Worker::allRatingsUploaded, this, &BatchRun::onUploadFinished);
+}
+
+BatchRun::~BatchRun()
+{
+    delete m_noteFormatter;
+}
+
+void BatchRun::start()
+{
+    m_totalTimer.start();
+    startPhase(LoginPhase);
+    m_worker->setUploadWindow(m_options.uploadWindow);
+    m_worker->prewarmConnections();
+    m_worker->tryLogin(m_options.userName, m_options.password);
+}
+
+void BatchRun::startPhase(Phase phase)
+{
+    if (m_phaseTimer.isValid())
+        m_phaseTimes[m_phase] = m_phaseTimer.elapsed();
+    m_phase = phase;
+    m_phaseTimer.start();
+}
+
+void BatchRun::onLoggedIn()
+{
+    startPhase(TemplatePhase);
+    m_worker->getCustomRatingTemplate();
+}
+
+void BatchRun::onTemplate(const RatingsStore &ratingsTemplate)
+{
+    m_template = ratingsTemplate;
+    if (m_options.sets.isEmpty())
+        m_options.sets = m_template.sets();
+    startPhase(RatingsPhase);
+    if (m_options.cube)
+        m_worker->get17LCube(m_options.sets, SeventeenCube::formats(), SeventeenCube::colorFilters());
+    else
+        m_worker->get17LRatings(m_options.sets, m_options.format);
+}
+
+void BatchRun::onRatings(const QString &set, const SeventeenTable &ratings)
+{
+    m_seventeenLandsCards += ratings.size();
+    mergeSet(set, ratings);
+    onSetCompleted();
+}
+
+void BatchRun::onSlice(const QString &set, const QString &format, const QString &colors, const SeventeenTable &ratings)
+{
+    m_seventeenLandsCards += ratings.size();
+    m_cube.insert(set, format, colors, ratings);
+}
+
+void BatchRun::onCubeDownloaded()
+{
+    const QStringList &sets = m_options.sets;
+    for (const QString &set : sets) {
+        const SeventeenTable *formatRatings = m_cube.slice(set, m_options.format);
+        const SeventeenTable ratings = m_options.blendFormats ? m_cube.blendFormats(set, SeventeenCube::formats())
+                                                              : (formatRatings ? *formatRatings : SeventeenTable());
+        if (ratings.isEmpty()) {
+            ++m_setsFailed;
+            continue;
+        }
+        m_noteFormatter->setCube(&m_cube, set, m_options.format, m_options.ratingMetric);
+        mergeSet(set, ratings);
+    }
+    m_setsCompleted = m_options.sets.size();
+    startUpload();
+}
+
+void BatchRun::mergeSet(const QString &set, const SeventeenTable &ratings)
+{
+    QElapsedTimer mergeTimer;
+    mergeTimer.start();
+    const NoteFormatter *noteFormatter = m_noteFormatter;
+    const QVector<RatingUpdate> updates =
+            RatingsMerger::merge(m_template, set, ratings, m_options.ratingMetric,
+                                 [noteFormatter](const SeventeenTable &table, int row) -> QString { return noteFormatter->format(table, row); },
+                                 m_options.normalization);
+    RatingsMerger::apply(m_template, updates);
+    m_mergedCards += updates.size();
+    m_phaseTimes[MergePhase] += mergeTimer.elapsed();
+}
+
+void BatchRun::onRatingsFailed()
+{
+    ++m_setsFailed;
+    onSetCompleted();
+}
+
+void BatchRun::onSetCompleted()
+{
+    if (++m_setsCompleted < m_options.sets.size())
+        return;
+    startUpload();
+}
+
+void BatchRun::startUpload()
+{
+    startPhase(UploadPhase);
+    if (m_setsFailed == m_options.sets.size()) {
+        finish(RatingsFailed);
+        return;
+    }
+    const QVector<MtgahCard> changedCards = m_template.dirtyCards(m_options.sets);
+    m_cardsToUpload = changedCards.size();
+    if (m_options.dryRun) {
+        finish(m_setsFailed > 0 ? RatingsFailed : Success);
+        return;
+    }
+    m_worker->uploadRatings(changedCards);
+}
+
+void BatchRun::onCardUploaded(bool succeeded)
+{
+    if (succeeded)
+        ++m_cardsUploaded;
+    else
+        ++m_uploadsFailed;
+}
+
+void BatchRun::onSetUploaded(const QString &set, int uploaded, int failed)
+{
+    QTextStream(stdout) << "Uploaded  " << set << ": " << uploaded << " cards, " << failed << " failed\n";
+}
+
+void BatchRun::onUploadFinished()
+{
+    if (m_phase != UploadPhase)
+        return;
+    if (m_setsFailed > 0)
+        finish(RatingsFailed);
+    else
+        finish(m_uploadsFailed > 0 ? UploadFailed : Success);
+}
+
+void BatchRun::finish(ExitCode exitCode)
+{
+    if (!m_phaseTimer.isValid())
+        return;
+    m_phaseTimes[m_phase] = m_phaseTimer.elapsed();
+    m_phaseTimer.invalidate();
+    printSummary();
+    if (exitCode != Success) {
+        static const char *const errors[] = {"", "invalid arguments", "login failed", "rating template download failed",
+                                             "17Lands download failed", "rating upload failed"};
+        std::fprintf(stderr, "Error: %s\n", errors[exitCode]);
+    }
+    emit finished(exitCode);
+}
+
+void BatchRun::printSummary() const
+{
+    QTextStream out(stdout);
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    out.setRealNumberPrecision(2);
+    out << "Login     " << m_phaseTimes[LoginPhase] / 1000.0 << " s\n";
+    out << "Template  " << m_phaseTimes[TemplatePhase] / 1000.0 << " s, " << m_template.size() << " cards, "
+        << perSecond(m_template.size(), m_phaseTimes[TemplatePhase]) << " cards/s\n";
+    out << "17Lands   " << m_phaseTimes[RatingsPhase] / 1000.0 << " s, " << m_setsCompleted - m_setsFailed << " of " << m_options.sets.size()
+        << " sets, " << m_seventeenLandsCards << " cards, " << perSecond(m_seventeenLandsCards, m_phaseTimes[RatingsPhase]) << " cards/s\n";
+    if (m_options.cube)
+        out << "Slices    " << m_cube.size() << " downloaded, " << m_slicesFailed << " without data\n";
+    out << "Merge     " << m_phaseTimes[MergePhase] / 1000.0 << " s, " << m_mergedCards << " cards, "
+        << perSecond(m_mergedCards, m_phaseTimes[MergePhase]) << " cards/s\n";
+    out << "Upload    " << m_phaseTimes[UploadPhase] / 1000.0 << " s, " << m_cardsUploaded << " of " << m_cardsToUpload << " changed cards, "
+        << m_uploadsFailed << " failed, " << m_uploadRate << " cards/s sustained"
+        << (m_options.dryRun ? " (dry run)\n" : "\n");
+    out << "Total     " << m_totalTimer.elapsed() / 1000.0 << " s\n";
+    const StringPool::Statistics poolStats = StringPool::statistics();
+    out << "Strings   " << poolStats.strings << " pooled, " << poolStats.lookups << " lookups, " << poolStats.savedBytes / 1024
+        << " KiB of duplicates shared\n";
+    const ConnectionStatsMap &connectionStats = m_worker->connectionStats();
+    for (auto i = connectionStats.cbegin(), iEnd = connectionStats.cend(); i != iEnd; ++i) {
+        out << i.key() << ": " << i->requests << " requests, " << i->tlsHandshakes << " TLS handshakes, " << i->http2Replies << " over HTTP/2, "
+            << i->compressedReplies << " compressed, " << i->errors << " errors, " << i->wireBytes / 1024 << " KiB\n";
+    }
+}
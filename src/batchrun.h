@@ -0,0 +1,96 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef BATCHRUN_H
+#define BATCHRUN_H
+#include "ratingsstore.h"
+#include "seventeencube.h"
+#include "seventeentable.h"
+#include <QElapsedTimer>
+#include <QLocale>
+#include <QObject>
+#include <QStringList>
+class Worker;
+class NoteFormatter;
+struct BatchOptions
+{
+    BatchOptions();
+    QString userName;
+    QString password;
+    // empty means every set in the rating template
+    QStringList sets;
+    QString format;
+    int ratingMetric;
+    SeventeenTable::Normalization normalization;
+    quint32 noteMetrics;
+    QLocale locale;
+    bool dryRun;
+    // download every format and color pair, the note gets the best archetype and the other formats
+    bool cube;
+    // rate on the statistics of all the formats together, needs cube
+    bool blendFormats;
+    // rating PUTs in flight at the same time
+    int uploadWindow;
+};
+// Login, template download, 17Lands download, merge and upload of the changed cards, without any widget
+class BatchRun : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(BatchRun)
+public:
+    enum ExitCode { Success = 0, UsageError, LoginFailed, TemplateFailed, RatingsFailed, UploadFailed };
+    explicit BatchRun(const BatchOptions &options, QObject *parent = nullptr);
+    ~BatchRun();
+    void start();
+signals:
+    void finished(int exitCode);
+
+private:
+    // merging happens while the 17Lands downloads are still running, its time is accumulated separately
+    enum Phase { LoginPhase, TemplatePhase, RatingsPhase, MergePhase, UploadPhase, PhaseCount };
+    void onLoggedIn();
+    void onTemplate(const RatingsStore &ratingsTemplate);
+    void onRatings(const QString &set, const SeventeenTable &ratings);
+    void onRatingsFailed();
+    void onSetCompleted();
+    void onSlice(const QString &set, const QString &format, const QString &colors, const SeventeenTable &ratings);
+    void onCubeDownloaded();
+    void mergeSet(const QString &set, const SeventeenTable &ratings);
+    void startUpload();
+    void onCardUploaded(bool succeeded);
+    void onSetUploaded(const QString &set, int uploaded, int failed);
+    void onUploadFinished();
+    void startPhase(Phase phase);
+    void finish(ExitCode exitCode);
+    void printSummary() const;
+    BatchOptions m_options;
+    Worker *m_worker;
+    NoteFormatter *m_noteFormatter;
+    RatingsStore m_template;
+    SeventeenCube m_cube;
+    QElapsedTimer m_totalTimer;
+    QElapsedTimer m_phaseTimer;
+    qint64 m_phaseTimes[PhaseCount];
+    Phase m_phase;
+    int m_setsCompleted;
+    int m_setsFailed;
+    int m_slicesFailed;
+    int m_seventeenLandsCards;
+    int m_mergedCards;
+    int m_cardsToUpload;
+    int m_cardsUploaded;
+    int m_uploadsFailed;
+    double m_uploadRate;
+};
+#endif
@@ -0,0 +1,126 @@
+#include "batchrun.h"
+#include "slmetrics.h"
+#include "tracer.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <cstdio>
+namespace {
+int metricForKey(const QString &key)
+{
+    for (int i = 0; i < SLCount; ++i) {
+        if (key == QLatin1String(slMetricDescriptors[i].jsonKey))
+            return i;
+    }
+    return -1;
+}
+
+QString metricKeys()
+{
+    QStringList result;
+    for (int i = 0; i < SLCount; ++i)
+        result.append(QLatin1String(slMetricDescriptors[i].jsonKey));
+    return result.join(QLatin1String(", "));
+}
+
+int normalizationForKey(const QString &key)
+{
+    static const char *const keys[] = {"linear", "percentile", "zscore", "shrunk"};
+    static_assert(sizeof(keys) / sizeof(keys[0]) == SeventeenTable::NormalizationCount, "every normalization needs a key");
+    for (int i = 0; i < SeventeenTable::NormalizationCount; ++i) {
+        if (key == QLatin1String(keys[i]))
+            return i;
+    }
+    return -1;
+}
+
+int usageError(const QString &message)
+{
+    std::fprintf(stderr, "%s\n", qPrintable(message));
+    return BatchRun::UsageError;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("17HelperCli"));
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Rates the cards of MTGAHelper from the 17Lands statistics without any user interface.\n"
+                                                    "The password can be passed in the SEVENTEENHELPER_PASSWORD environment variable.\n"
+                                                    "Metrics: ")
+                                     + metricKeys());
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("sets"), QStringLiteral("Sets to rate, all the sets of the template if omitted."),
+                                 QStringLiteral("[sets...]"));
+    const QCommandLineOption userOption(QStringLiteral("user"), QStringLiteral("MTGAHelper user name."), QStringLiteral("email"));
+    const QCommandLineOption passwordOption(QStringLiteral("password"), QStringLiteral("MTGAHelper password."), QStringLiteral("password"));
+    const QCommandLineOption formatOption(QStringLiteral("format"), QStringLiteral("17Lands format."), QStringLiteral("format"),
+                                          QStringLiteral("PremierDraft"));
+    const QCommandLineOption metricOption(QStringLiteral("metric"), QStringLiteral("Metric the rating is based on."), QStringLiteral("metric"),
+                                          QLatin1String(slMetricDescriptors[SLdrawn_win_rate].jsonKey));
+    const QCommandLineOption normalizationOption(QStringLiteral("scale"),
+                                                 QStringLiteral("How the metric is mapped to the ratings: linear, percentile, zscore or shrunk."),
+                                                 QStringLiteral("scale"), QStringLiteral("linear"));
+    const QCommandLineOption noteOption(QStringLiteral("note"), QStringLiteral("Comma separated metrics written in the note, \"none\" for no note."),
+                                        QStringLiteral("metrics"));
+    const QCommandLineOption localeOption(QStringLiteral("locale"), QStringLiteral("Locale used to format the note."), QStringLiteral("locale"));
+    const QCommandLineOption dryRunOption(QStringLiteral("dry-run"), QStringLiteral("Compute the ratings but do not upload them."));
+    const QCommandLineOption cubeOption(
+            QStringLiteral("cube"), QStringLiteral("Download every format and color pair, the note shows the best archetype and the other formats."));
+    const QCommandLineOption traceOption(QStringLiteral("trace"), QStringLiteral("Write the timing of every stage as Chrome trace JSON."),
+                                         QStringLiteral("file"));
+    const QCommandLineOption blendOption(QStringLiteral("blend"), QStringLiteral("Rate on all the formats together, implies --cube."));
+    const QCommandLineOption windowOption(QStringLiteral("upload-window"), QStringLiteral("Rating uploads in flight at the same time."),
+                                          QStringLiteral("requests"), QString::number(BatchOptions().uploadWindow));
+    parser.addOptions({userOption, passwordOption, formatOption, metricOption, normalizationOption, noteOption, localeOption, dryRunOption,
+                       cubeOption, blendOption, traceOption, windowOption});
+    parser.process(app);
+
+    BatchOptions options;
+    options.userName = parser.value(userOption);
+    options.password = parser.isSet(passwordOption) ? parser.value(passwordOption) : qEnvironmentVariable("SEVENTEENHELPER_PASSWORD");
+    if (options.userName.isEmpty() || options.password.isEmpty())
+        return usageError(QStringLiteral("A user name and a password are required."));
+    for (const QString &set : parser.positionalArguments())
+        options.sets.append(set.trimmed().toUpper());
+    options.format = parser.value(formatOption);
+    options.ratingMetric = metricForKey(parser.value(metricOption));
+    if (options.ratingMetric < 0)
+        return usageError(QStringLiteral("Unknown metric: ") + parser.value(metricOption));
+    const int normalization = normalizationForKey(parser.value(normalizationOption));
+    if (normalization < 0)
+        return usageError(QStringLiteral("Unknown scale: ") + parser.value(normalizationOption));
+    options.normalization = static_cast<SeventeenTable::Normalization>(normalization);
+    if (parser.isSet(noteOption)) {
+        options.noteMetrics = 0;
+        const QStringList noteKeys = parser.value(noteOption).split(QLatin1Char(','), Qt::SkipEmptyParts);
+        if (noteKeys != QStringList(QStringLiteral("none"))) {
+            for (const QString &noteKey : noteKeys) {
+                const int metric = metricForKey(noteKey.trimmed());
+                if (metric < 0)
+                    return usageError(QStringLiteral("Unknown metric: ") + noteKey);
+                options.noteMetrics |= slMetricBit(metric);
+            }
+        }
+    }
+    if (parser.isSet(localeOption))
+        options.locale = QLocale(parser.value(localeOption));
+    options.dryRun = parser.isSet(dryRunOption);
+    options.blendFormats = parser.isSet(blendOption);
+    options.cube = options.blendFormats || parser.isSet(cubeOption);
+    bool validWindow = false;
+    options.uploadWindow = parser.value(windowOption).toInt(&validWindow);
+    if (!validWindow || options.uploadWindow < 1)
+        return usageError(QStringLiteral("Invalid upload window: ") + parser.value(windowOption));
+
+    if (parser.isSet(traceOption))
+        Tracer::start(parser.value(traceOption));
+    else
+        Tracer::startFromEnvironment();
+    BatchRun run(options);
+    QObject::connect(&run, &BatchRun::finished, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+    run.start();
+    const int result = app.exec();
+    Tracer::stop();
+    return result;
+}
@@ -0,0 +1,55 @@
+#include "connectionstats.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+HostConnectionStats::HostConnectionStats()
+    : requests(0)
+    , tlsHandshakes(0)
+    , http2Replies(0)
+    , compressedReplies(0)
+    , errors(0)
+    , wireBytes(0)
+{ }
+
+ConnectionStats::ConnectionStats(QNetworkAccessManager *nam, QObject *parent)
+    : QObject(parent)
+{
+#ifndef QT_NO_SSL
+    connect(nam, &QNetworkAccessManager::encrypted, this, &ConnectionStats::onEncrypted);
+#endif
+    connect(nam, &QNetworkAccessManager::finished, this, &ConnectionStats::onFinished);
+}
+
+const ConnectionStatsMap &ConnectionStats::stats() const
+{
+    return m_stats;
+}
+
+void ConnectionStats::reset()
+{
+    m_stats.clear();
+}
+
+void ConnectionStats::track(QNetworkReply *reply)
+{
+    m_received.insert(reply, 0);
+    connect(reply, &QNetworkReply::downloadProgress, this, [this, reply](qint64 bytesReceived, qint64) { m_received[reply] = bytesReceived; });
+}
+
+void ConnectionStats::onEncrypted(QNetworkReply *reply)
+{
+    ++m_stats[reply->url().host()].tlsHandshakes;
+}
+
+void ConnectionStats::onFinished(QNetworkReply *reply)
+{
+    HostConnectionStats &hostStats = m_stats[reply->url().host()];
+    ++hostStats.requests;
+    if (reply->error() != QNetworkReply::NoError)
+        ++hostStats.errors;
+    if (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool())
+        ++hostStats.http2Replies;
+    if (!reply->rawHeader(QByteArrayLiteral("Content-Encoding")).isEmpty())
+        ++hostStats.compressedReplies;
+    hostStats.wireBytes += m_received.take(reply);
+}
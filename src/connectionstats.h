@@ -0,0 +1,56 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef CONNECTIONSTATS_H
+#define CONNECTIONSTATS_H
+#include <QHash>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+class QNetworkAccessManager;
+class QNetworkReply;
+struct HostConnectionStats
+{
+    HostConnectionStats();
+    int requests;
+    // every handshake is a connection that could not be reused
+    int tlsHandshakes;
+    int http2Replies;
+    int compressedReplies;
+    int errors;
+    // body bytes received, from the download progress of the tracked replies
+    qint64 wireBytes;
+};
+Q_DECLARE_TYPEINFO(HostConnectionStats, Q_PRIMITIVE_TYPE);
+typedef QHash<QString, HostConnectionStats> ConnectionStatsMap;
+// Counts, per host, what happened to the replies of a QNetworkAccessManager.
+// Received bytes are only known for the replies passed to track().
+class ConnectionStats : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(ConnectionStats)
+public:
+    explicit ConnectionStats(QNetworkAccessManager *nam, QObject *parent = nullptr);
+    const ConnectionStatsMap &stats() const;
+    void reset();
+    void track(QNetworkReply *reply);
+
+private:
+    void onEncrypted(QNetworkReply *reply);
+    void onFinished(QNetworkReply *reply);
+    ConnectionStatsMap m_stats;
+    QHash<QNetworkReply *, qint64> m_received;
+};
+Q_DECLARE_METATYPE(ConnectionStatsMap)
+#endif
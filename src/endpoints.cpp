@@ -0,0 +1,56 @@
+#include "endpoints.h"
+#include <QtGlobal>
+
+Endpoints::Endpoints()
+{
+    for (int i = 0; i < ServiceCount; ++i)
+        m_baseUrls[i] = defaultBaseUrl(static_cast<Service>(i));
+}
+
+QUrl Endpoints::baseUrl(Service service) const
+{
+    Q_ASSERT(service >= 0 && service < ServiceCount);
+    return m_baseUrls[service];
+}
+
+void Endpoints::setBaseUrl(Service service, const QUrl &url)
+{
+    Q_ASSERT(service >= 0 && service < ServiceCount);
+    m_baseUrls[service] = url;
+}
+
+QUrl Endpoints::url(Service service, const QString &pathAndQuery) const
+{
+    return QUrl::fromUserInput(baseUrl(service).toString(QUrl::StripTrailingSlash) + pathAndQuery);
+}
+
+QUrl Endpoints::defaultBaseUrl(Service service)
+{
+    switch (service) {
+    case MtgaHelper:
+        return QUrl(QStringLiteral("https://mtgahelper.com"));
+    case Scryfall:
+        return QUrl(QStringLiteral("https://api.scryfall.com"));
+    case SeventeenLands:
+        return QUrl(QStringLiteral("https://www.17lands.com"));
+    default:
+        Q_UNREACHABLE();
+    }
+    return QUrl();
+}
+
+Endpoints Endpoints::fromEnvironment()
+{
+    Endpoints result;
+    const QString commonBase = qEnvironmentVariable("SEVENTEENHELPER_BASE_URL");
+    const char *const serviceVariables[ServiceCount] = {"SEVENTEENHELPER_MTGAHELPER_URL", "SEVENTEENHELPER_SCRYFALL_URL",
+                                                        "SEVENTEENHELPER_17LANDS_URL"};
+    for (int i = 0; i < ServiceCount; ++i) {
+        QString base = qEnvironmentVariable(serviceVariables[i]);
+        if (base.isEmpty())
+            base = commonBase;
+        if (!base.isEmpty())
+            result.setBaseUrl(static_cast<Service>(i), QUrl::fromUserInput(base));
+    }
+    return result;
+}
@@ -0,0 +1,38 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef ENDPOINTS_H
+#define ENDPOINTS_H
+#include <QMetaType>
+#include <QString>
+#include <QUrl>
+// Base URLs of the services Worker talks to.
+// fromEnvironment() lets SEVENTEENHELPER_BASE_URL redirect every service (e.g. to the stand-in server)
+// and SEVENTEENHELPER_MTGAHELPER_URL, SEVENTEENHELPER_SCRYFALL_URL, SEVENTEENHELPER_17LANDS_URL redirect a single one
+class Endpoints
+{
+public:
+    enum Service { MtgaHelper, Scryfall, SeventeenLands, ServiceCount };
+    Endpoints();
+    QUrl baseUrl(Service service) const;
+    void setBaseUrl(Service service, const QUrl &url);
+    QUrl url(Service service, const QString &pathAndQuery) const;
+    static QUrl defaultBaseUrl(Service service);
+    static Endpoints fromEnvironment();
+
+private:
+    QUrl m_baseUrls[ServiceCount];
+};
+Q_DECLARE_METATYPE(Endpoints)
+#endif
@@ -0,0 +1,175 @@
+#include "fetchchunkproxymodel.h"
+#include <algorithm>
+
+FetchChunkProxyModel::FetchChunkProxyModel(int fetchChunk, QObject *parent)
+    : QAbstractProxyModel(parent)
+    , m_fetchChunk(std::max(1, fetchChunk))
+    , m_exposedRows(0)
+    , m_pendingRows(0)
+{ }
+
+void FetchChunkProxyModel::setSourceModel(QAbstractItemModel *newSourceModel)
+{
+    beginResetModel();
+    const QVector<QMetaObject::Connection> &sourceConnections = m_sourceConnections;
+    for (const QMetaObject::Connection &connection : sourceConnections)
+        disconnect(connection);
+    m_sourceConnections.clear();
+    QAbstractProxyModel::setSourceModel(newSourceModel);
+    if (newSourceModel) {
+        // the source is flat, moving rows starts over like a reset
+        const auto beginReset = [this]() { beginResetModel(); };
+        const auto endReset = [this]() {
+            resetExposedRows();
+            endResetModel();
+        };
+        m_sourceConnections = {
+                connect(newSourceModel, &QAbstractItemModel::dataChanged, this, &FetchChunkProxyModel::onSourceDataChanged),
+                connect(newSourceModel, &QAbstractItemModel::headerDataChanged, this, &QAbstractItemModel::headerDataChanged),
+                connect(newSourceModel, &QAbstractItemModel::rowsAboutToBeInserted, this, &FetchChunkProxyModel::onSourceRowsAboutToBeInserted),
+                connect(newSourceModel, &QAbstractItemModel::rowsInserted, this, &FetchChunkProxyModel::onSourceRowsInserted),
+                connect(newSourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &FetchChunkProxyModel::onSourceRowsAboutToBeRemoved),
+                connect(newSourceModel, &QAbstractItemModel::rowsRemoved, this, &FetchChunkProxyModel::onSourceRowsRemoved),
+                connect(newSourceModel, &QAbstractItemModel::rowsAboutToBeMoved, this, beginReset),
+                connect(newSourceModel, &QAbstractItemModel::rowsMoved, this, endReset),
+                connect(newSourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, &FetchChunkProxyModel::onSourceLayoutAboutToBeChanged),
+                connect(newSourceModel, &QAbstractItemModel::layoutChanged, this, &FetchChunkProxyModel::onSourceLayoutChanged),
+                connect(newSourceModel, &QAbstractItemModel::modelAboutToBeReset, this, beginReset),
+                connect(newSourceModel, &QAbstractItemModel::modelReset, this, endReset),
+        };
+    }
+    resetExposedRows();
+    endResetModel();
+}
+
+bool FetchChunkProxyModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && sourceModel() && m_exposedRows < sourceModel()->rowCount();
+}
+
+void FetchChunkProxyModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+    const int exposed = std::min(sourceModel()->rowCount(), m_exposedRows + m_fetchChunk);
+    beginInsertRows(QModelIndex(), m_exposedRows, exposed - 1);
+    m_exposedRows = exposed;
+    endInsertRows();
+}
+
+void FetchChunkProxyModel::resetExposedRows()
+{
+    m_exposedRows = sourceModel() ? std::min(m_fetchChunk, sourceModel()->rowCount()) : 0;
+}
+
+void FetchChunkProxyModel::onSourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last)
+{
+    m_pendingRows = 0;
+    // rows inserted inside the exposed ones or right after all of them are exposed, past them they wait for fetchMore()
+    if (parent.isValid() || (first >= m_exposedRows && m_exposedRows < sourceModel()->rowCount()))
+        return;
+    m_pendingRows = last - first + 1;
+    beginInsertRows(QModelIndex(), first, last);
+}
+
+void FetchChunkProxyModel::onSourceRowsInserted()
+{
+    if (m_pendingRows == 0)
+        return;
+    m_exposedRows += m_pendingRows;
+    m_pendingRows = 0;
+    endInsertRows();
+}
+
+void FetchChunkProxyModel::onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    m_pendingRows = 0;
+    if (parent.isValid() || first >= m_exposedRows)
+        return;
+    last = std::min(last, m_exposedRows - 1);
+    m_pendingRows = last - first + 1;
+    beginRemoveRows(QModelIndex(), first, last);
+}
+
+void FetchChunkProxyModel::onSourceRowsRemoved()
+{
+    if (m_pendingRows == 0)
+        return;
+    m_exposedRows -= m_pendingRows;
+    m_pendingRows = 0;
+    endRemoveRows();
+}
+
+// a sort brings different rows to the top, the exposed ones stay the first rows of the new order
+void FetchChunkProxyModel::onSourceLayoutAboutToBeChanged()
+{
+    emit layoutAboutToBeChanged();
+    const QModelIndexList proxyIndexes = persistentIndexList();
+    m_layoutIndexes.clear();
+    m_layoutIndexes.reserve(proxyIndexes.size());
+    for (const QModelIndex &proxyIndex : proxyIndexes)
+        m_layoutIndexes.append(std::make_pair(proxyIndex, QPersistentModelIndex(mapToSource(proxyIndex))));
+}
+
+void FetchChunkProxyModel::onSourceLayoutChanged()
+{
+    const QVector<std::pair<QModelIndex, QPersistentModelIndex>> &layoutIndexes = m_layoutIndexes;
+    for (const std::pair<QModelIndex, QPersistentModelIndex> &layoutIndex : layoutIndexes)
+        changePersistentIndex(layoutIndex.first, mapFromSource(layoutIndex.second));
+    m_layoutIndexes.clear();
+    emit layoutChanged();
+}
+
+void FetchChunkProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    const int lastRow = std::min(bottomRight.row(), m_exposedRows - 1);
+    if (topLeft.row() > lastRow)
+        return;
+    emit dataChanged(index(topLeft.row(), topLeft.column()), index(lastRow, bottomRight.column()), roles);
+}
+
+QModelIndex FetchChunkProxyModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid() || !sourceModel())
+        return QModelIndex();
+    return sourceModel()->index(proxyIndex.row(), proxyIndex.column());
+}
+
+QModelIndex FetchChunkProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid() || sourceIndex.row() >= m_exposedRows)
+        return QModelIndex();
+    return createIndex(sourceIndex.row(), sourceIndex.column());
+}
+
+QModelIndex FetchChunkProxyModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (parent.isValid() || row < 0 || row >= rowCount() || column < 0 || column >= columnCount())
+        return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex FetchChunkProxyModel::parent(const QModelIndex &child) const
+{
+    Q_UNUSED(child)
+    return QModelIndex();
+}
+
+QModelIndex FetchChunkProxyModel::sibling(int row, int column, const QModelIndex &idx) const
+{
+    return index(row, column, idx.parent());
+}
+
+int FetchChunkProxyModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_exposedRows;
+}
+
+int FetchChunkProxyModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !sourceModel())
+        return 0;
+    return sourceModel()->columnCount();
+}
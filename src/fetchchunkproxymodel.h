@@ -0,0 +1,59 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef FETCHCHUNKPROXYMODEL_H
+#define FETCHCHUNKPROXYMODEL_H
+#include <QAbstractProxyModel>
+#include <QPersistentModelIndex>
+#include <QVector>
+#include <utility>
+// Shows the first rows of a flat model and exposes the rest a chunk at a time through fetchMore().
+// Sits above the sorting so the exposed rows are always the top of the sorted order.
+class FetchChunkProxyModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(FetchChunkProxyModel)
+public:
+    explicit FetchChunkProxyModel(int fetchChunk, QObject *parent = nullptr);
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    QModelIndex sibling(int row, int column, const QModelIndex &idx) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    void resetExposedRows();
+    void onSourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void onSourceRowsInserted();
+    void onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceRowsRemoved();
+    void onSourceLayoutAboutToBeChanged();
+    void onSourceLayoutChanged();
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    int m_fetchChunk;
+    // the proxy rows are the first m_exposedRows rows of the source
+    int m_exposedRows;
+    // rows inserted or removed inside the exposed ones, 0 while the change is past them
+    int m_pendingRows;
+    // persistent indexes of the proxy and where they are in the source while the source layout changes
+    QVector<std::pair<QModelIndex, QPersistentModelIndex>> m_layoutIndexes;
+    QVector<QMetaObject::Connection> m_sourceConnections;
+};
+
+#endif
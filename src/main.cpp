@@ -1,13 +1,17 @@
 #include <QApplication>
 #include <QTranslator>
 #include <mainwindow.h>
+#include <tracer.h>
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
+    Tracer::startFromEnvironment();
     QTranslator translator;
     if (translator.load(QLocale(), QLatin1String("17Helper"), QLatin1String("_"), QLatin1String(":/i18n")))
         app.installTranslator(&translator);
     MainWindow w;
     w.show();
-    return app.exec();
+    const int result = app.exec();
+    Tracer::stop();
+    return result;
 }
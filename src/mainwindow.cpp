@@ -11,17 +11,33 @@
    limitations under the License.
 \****************************************************************************/
 
+#include "fetchchunkproxymodel.h"
 #include "mainwindow.h"
+#include "noteformatter.h"
 #include "ratingsdelegate.h"
 #include "ratingsmodel.h"
+#include "setfilterproxymodel.h"
+#include "setsmodel.h"
 #include "ui_mainwindow.h"
 #include "worker.h"
 #include <QCoreApplication>
 #include <QDesktopServices>
 #include <QHeaderView>
 #include <QIdentityProxyModel>
+#include <QScrollBar>
 #include <QSortFilterProxyModel>
 #include <QStandardItemModel>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <functional>
+namespace {
+// rows recomputed per event loop pass after the visible ones
+const int rerateChunkSize = 512;
+// sorted rows handed to the ratings view per fetch, the first chunk is all the first paint needs
+const int ratingsFetchChunk = 256;
+}
+
 class NoCheckProxy : public QIdentityProxyModel
 {
     Q_DISABLE_COPY_MOVE(NoCheckProxy)
@@ -40,49 +56,52 @@ void MainWindow::doLogin()
     ui->loginButton->setEnabled(false);
     ui->usernameEdit->setEnabled(false);
     ui->pwdEdit->setEnabled(false);
-    m_worker->tryLogin(ui->usernameEdit->text(), ui->pwdEdit->text());
+    QMetaObject::invokeMethod(m_worker, std::bind(&Worker::tryLogin, m_worker, ui->usernameEdit->text(), ui->pwdEdit->text()));
     ui->pwdEdit->clear();
 }
 
 void MainWindow::doLogout()
 {
     ui->logoutButton->setEnabled(false);
-    m_worker->logOut();
+    QMetaObject::invokeMethod(m_worker, &Worker::logOut);
 }
 
 void MainWindow::do17Ldownload()
 {
     ui->downloadButton->setEnabled(false);
     ui->setsGroup->setEnabled(false);
-    QStringList sets;
-    for (int i = 0, iEnd = m_setsModel->rowCount(); i < iEnd; ++i) {
-        const QModelIndex &idx = m_setsModel->index(i, 0);
-        if (idx.data(Qt::CheckStateRole).toInt() == Qt::Checked)
-            sets.append(idx.data(Qt::UserRole).toString());
-    }
+    const QStringList sets = m_setsModel->checkedSets();
     ui->progressBar->setVisible(true);
     ui->progressLabel->setVisible(true);
     ui->progressBar->setRange(0, sets.size());
     ui->progressBar->setValue(0);
     ui->progressLabel->setText(tr("Downloading 17 Lands Data"));
-    m_worker->get17LRatings(sets, ui->formatsCombo->currentData().toString());
+    QMetaObject::invokeMethod(m_worker, std::bind(&Worker::get17LRatings, m_worker, sets, ui->formatsCombo->currentData().toString()));
 }
 
 void MainWindow::doMtgahUpload()
 {
+    finishRerate();
     ui->uploadButton->setEnabled(false);
     ui->progressBar->setVisible(true);
     ui->progressBar->setRange(0, 1);
     ui->progressBar->setValue(0);
     ui->progressLabel->setVisible(true);
-    ui->progressLabel->setText(tr("Uploading"));
-    QStringList sets;
-    for (int i = 0, iEnd = m_setsModel->rowCount(); i < iEnd; ++i) {
-        const QModelIndex &idx = m_setsModel->index(i, 0);
-        if (idx.data(Qt::CheckStateRole).toInt() == Qt::Checked)
-            sets.append(idx.data(Qt::UserRole).toString());
-    }
-    m_worker->uploadRatings(sets);
+    const QStringList sets = m_setsModel->checkedSets();
+    const QVector<MtgahCard> changedCards = m_ratingsModel->ratingsTemplate().dirtyCards(sets);
+    ui->progressLabel->setText(tr("Uploading %1 changed of %2").arg(changedCards.size()).arg(m_ratingsModel->ratingsTemplate().count(sets)));
+    QMetaObject::invokeMethod(m_worker, std::bind(&Worker::uploadRatings, m_worker, changedCards));
+}
+
+void MainWindow::onPendingUploadsFound(int count)
+{
+    ui->uploadButton->setEnabled(false);
+    ui->progressBar->setVisible(true);
+    ui->progressBar->setRange(0, count);
+    ui->progressBar->setValue(0);
+    ui->progressLabel->setVisible(true);
+    ui->progressLabel->setText(tr("Resuming %n interrupted upload(s)", nullptr, count));
+    QMetaObject::invokeMethod(m_worker, &Worker::resumeUploads);
 }
 
 void MainWindow::onAllRatingsUploaded()
@@ -95,52 +114,121 @@ void MainWindow::onAllRatingsUploaded()
 void MainWindow::fillSets(const QStringList &sets)
 {
     m_error &= ~MTGAHSetsError;
-    m_setsModel->removeRows(0, m_setsModel->rowCount());
-    Qt::CheckState checkState = Qt::Checked;
-    for (int i = sets.size() - 1; i >= 0; --i) {
-        auto item = new QStandardItem;
-        item->setData(sets.at(i), Qt::DisplayRole);
-        item->setData(sets.at(i), Qt::UserRole);
-        item->setData(checkState, Qt::CheckStateRole);
-        item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
-        m_setsModel->insertRow(m_setsModel->rowCount(), item);
-        checkState = Qt::Unchecked;
+    // newest first, only the newest checked
+    QStringList newestFirst;
+    newestFirst.reserve(sets.size());
+    for (int i = sets.size() - 1; i >= 0; --i)
+        newestFirst.append(sets.at(i));
+    // sets shown from the snapshot are revalidated, keep what the user checked in the meantime
+    if (newestFirst != m_setsModel->sets()) {
+        const QStringList checkedSets = m_setsModel->checkedSets();
+        m_setsModel->setSets(newestFirst);
+        bool anyChecked = false;
+        for (int i = 0, iEnd = newestFirst.size(); i < iEnd; ++i) {
+            if (checkedSets.contains(newestFirst.at(i))) {
+                m_setsModel->setChecked(i, true);
+                anyChecked = true;
+            }
+        }
+        if (!anyChecked && !newestFirst.isEmpty())
+            m_setsModel->setChecked(0, true);
     }
-    m_worker->downloadSetsScryfall();
     retranslateUi();
 }
 
 void MainWindow::fillSetNames(const QHash<QString, QString> &setNames)
 {
-    for (int i = 0, iEnd = m_setsModel->rowCount(); i < iEnd; ++i) {
-        const QString setToFind = m_setsModel->index(i, 0).data(Qt::UserRole).toString();
-        auto nameIter = setNames.constFind(setToFind);
-        if (nameIter != setNames.constEnd())
-            m_setsModel->setData(m_setsModel->index(i, 0), nameIter.value());
-    }
+    m_setsModel->setSetNames(setNames);
     retranslateUi();
 }
 
-void MainWindow::onDownloaded17LRatings(const QString &set, const QSet<SeventeenCard> &ratings)
+void MainWindow::onDownloaded17LRatings(const QString &set, const SeventeenTable &ratings)
 {
     Q_ASSERT(!ratings.isEmpty());
-    const auto ratingComparison = [this](const SeventeenCard &a, const SeventeenCard &b) -> bool { return ratingValue(a) < ratingValue(b); };
-    const auto minMaxRtg = std::minmax_element(ratings.cbegin(), ratings.cend(), ratingComparison);
-    const double minRtgValue = ratingValue(*minMaxRtg.first);
-    double ratingDenominator = ratingValue(*minMaxRtg.second) - minRtgValue;
-    if (ratingDenominator == 0.0)
-        ratingDenominator = 1.0;
-    for (int i = 0, iEnd = m_ratingsModel->rowCount(); i < iEnd; ++i) {
-        QCoreApplication::processEvents();
-        if (m_ratingsModel->index(i, RatingsModel::rmcSet).data().toString() != set)
-            continue;
-        const auto rtgIter = ratings.constFind(SeventeenCard(m_ratingsModel->index(i, RatingsModel::rmcName).data().toString()));
-        if (rtgIter == ratings.constEnd())
-            continue;
-        m_ratingsModel->setData(m_ratingsModel->index(i, RatingsModel::rmcRating),
-                                qRound(10.0 * (ratingValue(*rtgIter) - minRtgValue) / ratingDenominator));
-        m_ratingsModel->setData(m_ratingsModel->index(i, RatingsModel::rmcNote), commentString(*rtgIter));
+    m_seventeenLandsStats.insert(set, ratings);
+    const NoteFormatter noteFormatter(locale(), SLcodes, selectedNoteMetrics());
+    const QVector<RatingUpdate> updates = RatingsMerger::merge(
+            m_ratingsModel->ratingsTemplate(), set, ratings, ui->ratingBasedCombo->currentData().toInt(),
+            [&noteFormatter](const SeventeenTable &table, int row) -> QString { return noteFormatter.format(table, row); }, selectedNormalization());
+    m_ratingsProxy->setDynamicSortFilter(false);
+    m_ratingsModel->applyUpdates(updates);
+    // a running re-rating sorts once it is done
+    m_ratingsProxy->setDynamicSortFilter(m_rerateParts == 0);
+}
+
+void MainWindow::scheduleRerate(int updateParts)
+{
+    m_rerateParts |= updateParts;
+    if (m_rerateParts == 0 || m_seventeenLandsStats.isEmpty()) {
+        m_rerateParts = 0;
+        return;
+    }
+    const RatingsStore &ratingsTemplate = m_ratingsModel->ratingsTemplate();
+    m_reratePending = QBitArray(ratingsTemplate.size());
+    const QStringList sets = m_seventeenLandsStats.sets();
+    for (const QString &set : sets) {
+        const std::pair<int, int> range = ratingsTemplate.setRange(set);
+        if (range.first < range.second)
+            m_reratePending.fill(true, range.first, range.second);
+    }
+    m_rerateCursor = 0;
+    m_ratingsProxy->setDynamicSortFilter(false);
+    rerateVisibleRows();
+    m_rerateTimer->start();
+}
+
+void MainWindow::rerateVisibleRows()
+{
+    if (m_rerateParts == 0)
+        return;
+    const int firstVisible = ui->ratingsView->rowAt(0);
+    if (firstVisible < 0)
+        return;
+    int lastVisible = ui->ratingsView->rowAt(ui->ratingsView->viewport()->height() - 1);
+    if (lastVisible < 0)
+        lastVisible = m_fetchProxy->rowCount() - 1;
+    QVector<int> rows;
+    for (int i = firstVisible; i <= lastVisible; ++i) {
+        const int row = m_setFilterProxy->mapToSource(m_ratingsProxy->mapToSource(m_ratingsProxy->index(i, 0))).row();
+        if (row >= 0 && row < m_reratePending.size() && m_reratePending.testBit(row)) {
+            m_reratePending.clearBit(row);
+            rows.append(row);
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    applyRerate(rows);
+}
+
+void MainWindow::rerateNextChunk()
+{
+    QVector<int> rows;
+    for (const int pendingSize = m_reratePending.size(); m_rerateCursor < pendingSize && rows.size() < rerateChunkSize; ++m_rerateCursor) {
+        if (m_reratePending.testBit(m_rerateCursor))
+            rows.append(m_rerateCursor);
     }
+    applyRerate(rows);
+    if (m_rerateCursor < m_reratePending.size())
+        return;
+    m_rerateTimer->stop();
+    m_rerateParts = 0;
+    m_reratePending.clear();
+    m_ratingsProxy->setDynamicSortFilter(true);
+}
+
+void MainWindow::finishRerate()
+{
+    while (m_rerateParts != 0)
+        rerateNextChunk();
+}
+
+void MainWindow::applyRerate(const QVector<int> &rows)
+{
+    if (rows.isEmpty())
+        return;
+    const NoteFormatter noteFormatter(locale(), SLcodes, selectedNoteMetrics());
+    m_ratingsModel->applyUpdates(RatingsMerger::rerate(
+            m_ratingsModel->ratingsTemplate(), rows, m_seventeenLandsStats, ui->ratingBasedCombo->currentData().toInt(), selectedNormalization(),
+            m_rerateParts, [&noteFormatter](const SeventeenTable &table, int row) -> QString { return noteFormatter.format(table, row); }));
 }
 
 void MainWindow::onDownloadedAll17LRatings()
@@ -153,12 +241,6 @@ void MainWindow::onDownloadedAll17LRatings()
 
 void MainWindow::onDownload17LRatingsProgress(int progress)
 {
-    int setCount = 0;
-    for (int i = 0, iEnd = m_setsModel->rowCount(); i < iEnd; ++i) {
-        const QModelIndex &idx = m_setsModel->index(i, 0);
-        if (idx.data(Qt::CheckStateRole).toInt() == Qt::Checked)
-            ++setCount;
-    }
     ui->progressBar->setValue(ui->progressBar->maximum() - progress);
 }
 
@@ -167,7 +249,7 @@ void MainWindow::fillMetrics()
     for (int i = 0; i < SLCount; ++i) {
         QStandardItem *item = new QStandardItem;
         item->setData(i, Qt::UserRole);
-        if (i == SLdrawn_win_rate || i == SLavg_pick)
+        if (slMetricDescriptors[i].inDefaultNote)
             item->setData(Qt::Checked, Qt::CheckStateRole);
         else
             item->setData(Qt::Unchecked, Qt::CheckStateRole);
@@ -185,6 +267,9 @@ void MainWindow::onLogoutError()
 
 void MainWindow::onMTGAHSetsError()
 {
+    // the sets of the snapshot are still usable
+    if (m_setsModel->rowCount() > 0)
+        return;
     m_error |= MTGAHSetsError;
     ui->retryBasicDownloadButton->setEnabled(true);
     retranslateUi();
@@ -205,38 +290,28 @@ void MainWindow::onTemplateDownloadFailed()
 void MainWindow::retrySetsDownload()
 {
     ui->retryBasicDownloadButton->setEnabled(false);
-    m_worker->downloadSetsMTGAH();
+    QMetaObject::invokeMethod(m_worker, &Worker::downloadSetsMTGAH);
 }
 
 void MainWindow::retryTemplateDownload()
 {
     ui->retryTemplateButton->setEnabled(false);
-    m_worker->getCustomRatingTemplate();
+    QMetaObject::invokeMethod(m_worker, &Worker::getCustomRatingTemplate);
 }
 
-void MainWindow::onCustomRatingsTemplateDownloaded()
+void MainWindow::onCustomRatingsTemplateDownloaded(const RatingsStore &ratings)
 {
     m_error &= ~RatingTemplateFailed;
-    m_ratingsModel->setRatingsTemplate(m_worker->ratingsTemplate());
+    // statistics merged into the previous template do not carry over
+    m_seventeenLandsStats.clear();
+    m_ratingsModel->setRatingsTemplate(ratings);
     retranslateUi();
 }
 
-void MainWindow::updateRatingsFiler()
+void MainWindow::onCustomRatingsTemplateUnchanged()
 {
-    QString regExpString;
-    for (int i = 0, iEnd = m_setsModel->rowCount(); i != iEnd; ++i) {
-        const QModelIndex currIdx = m_setsModel->index(i, 0);
-        if (currIdx.data(Qt::CheckStateRole).toInt() == Qt::Checked) {
-            if (regExpString.isEmpty())
-                regExpString = QStringLiteral("(?:");
-            else
-                regExpString += QLatin1Char('|');
-            regExpString += currIdx.data(Qt::UserRole).toString();
-        }
-    }
-    if (!regExpString.isEmpty())
-        regExpString += QLatin1Char(')');
-    m_ratingsProxy->setFilterRegularExpression(regExpString);
+    m_error &= ~RatingTemplateFailed;
+    retranslateUi();
 }
 
 void MainWindow::onRatingsUploadMaxProgress(int maxRange)
@@ -252,6 +327,7 @@ void MainWindow::onRatingsUploadProgress(int progress)
 void MainWindow::onLogout()
 {
     m_error &= ~LogoutError;
+    m_seventeenLandsStats.clear();
     ui->usernameEdit->setEnabled(true);
     ui->pwdEdit->setEnabled(true);
     toggleLoginLogoutButtons();
@@ -262,12 +338,27 @@ void MainWindow::onLogout()
 void MainWindow::onLogin()
 {
     m_error &= ~LoginError;
-    m_worker->getCustomRatingTemplate();
+    QMetaObject::invokeMethod(m_worker, &Worker::getCustomRatingTemplate);
     toggleLoginLogoutButtons();
     enableSetsSection();
     retranslateUi();
 }
 
+void MainWindow::onSessionRestored(const QString &userName)
+{
+    ui->usernameEdit->setText(userName);
+    ui->loginButton->setEnabled(false);
+    ui->usernameEdit->setEnabled(false);
+    ui->pwdEdit->setEnabled(false);
+    onLogin();
+}
+
+void MainWindow::onSessionExpired()
+{
+    m_ratingsModel->setRatingsTemplate(RatingsStore());
+    onLogout();
+}
+
 void MainWindow::onLoginError()
 {
     m_error |= LoginError;
@@ -280,12 +371,17 @@ void MainWindow::onLoginError()
 MainWindow::MainWindow(QWidget *parent)
     : QWidget(parent)
     , m_error(NoError)
+    , m_rerateCursor(0)
+    , m_rerateParts(0)
     , ui(new Ui::MainWindow)
 {
     ui->setupUi(this);
-    m_worker = new Worker(this);
-    m_setsModel = new QStandardItemModel(this);
-    m_setsModel->insertColumn(0);
+    m_workerThread = new QThread(this);
+    m_worker = new Worker;
+    m_worker->moveToThread(m_workerThread);
+    connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_workerThread->start();
+    m_setsModel = new SetsModel(this);
     ui->setsView->setModel(m_setsModel);
     ui->logoutButton->hide();
     ui->errorLabel->hide();
@@ -298,13 +394,18 @@ MainWindow::MainWindow(QWidget *parent)
     ui->formatsCombo->addItem(QString(), QStringLiteral("Sealed"));
     ui->formatsCombo->addItem(QString(), QStringLiteral("TradSealed"));
     m_ratingsModel = new RatingsModel(this);
-    m_ratingsModel->setRatingsTemplate(m_worker->ratingsTemplate());
+    m_setFilterProxy = new SetFilterProxyModel(m_setsModel, RatingsModel::rmcSet, RatingsModel::SetIdRole, this);
+    m_setFilterProxy->setSourceModel(m_ratingsModel);
     m_ratingsProxy = new QSortFilterProxyModel(this);
-    m_ratingsProxy->setSourceModel(m_ratingsModel);
-    m_ratingsProxy->setFilterKeyColumn(RatingsModel::rmcSet);
-    ui->ratingsView->setModel(m_ratingsProxy);
+    m_ratingsProxy->setSourceModel(m_setFilterProxy);
+    m_ratingsProxy->setSortRole(RatingsModel::SortRole);
+    m_fetchProxy = new FetchChunkProxyModel(ratingsFetchChunk, this);
+    m_fetchProxy->setSourceModel(m_ratingsProxy);
+    ui->ratingsView->setModel(m_fetchProxy);
     ui->ratingsView->setColumnHidden(RatingsModel::rmcArenaId, true);
     ui->ratingsView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    // size the columns on the visible rows only
+    ui->ratingsView->horizontalHeader()->setResizeContentsPrecision(0);
     ui->ratingsView->sortByColumn(RatingsModel::rmcName, Qt::AscendingOrder);
     ui->ratingsView->setItemDelegateForColumn(RatingsModel::rmcRating, new RatingsDelegate(this));
     m_SLMetricsModel = new QStandardItemModel(SLCount, 1, this);
@@ -314,6 +415,10 @@ MainWindow::MainWindow(QWidget *parent)
     SLMetricsProxy->setSourceModel(m_SLMetricsModel);
     ui->ratingBasedCombo->setModel(SLMetricsProxy);
     ui->ratingBasedCombo->setCurrentIndex(SLdrawn_win_rate);
+    for (int i = 0; i < SeventeenTable::NormalizationCount; ++i)
+        ui->normalizationCombo->addItem(QString(), i);
+    m_rerateTimer = new QTimer(this);
+    m_rerateTimer->setInterval(0);
     disableSetsSection();
     retranslateUi();
 
@@ -333,25 +438,42 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_worker, &Worker::downloadSetsScryfallFailed, this, &MainWindow::onScryfallSetsError);
     connect(m_worker, &Worker::loggedIn, this, &MainWindow::onLogin);
     connect(m_worker, &Worker::loginFalied, this, &MainWindow::onLoginError);
+    connect(m_worker, &Worker::sessionRestored, this, &MainWindow::onSessionRestored);
+    connect(m_worker, &Worker::sessionExpired, this, &MainWindow::onSessionExpired);
     connect(m_worker, &Worker::loggedOut, this, &MainWindow::onLogout);
     connect(m_worker, &Worker::logoutFailed, this, &MainWindow::onLogoutError);
     connect(m_worker, &Worker::customRatingTemplate, this, &MainWindow::onCustomRatingsTemplateDownloaded);
     connect(m_worker, &Worker::customRatingTemplateFailed, this, &MainWindow::onTemplateDownloadFailed);
+    connect(m_worker, &Worker::customRatingTemplateUnchanged, this, &MainWindow::onCustomRatingsTemplateUnchanged);
     connect(m_worker, &Worker::downloaded17LRatings, this, &MainWindow::onDownloaded17LRatings);
     connect(m_worker, &Worker::downloadedAll17LRatings, this, &MainWindow::onDownloadedAll17LRatings);
     connect(m_worker, &Worker::ratingsUploadMaxProgress, this, &MainWindow::onRatingsUploadMaxProgress);
     connect(m_worker, &Worker::ratingsUploadProgress, this, &MainWindow::onRatingsUploadProgress);
     connect(m_worker, &Worker::allRatingsUploaded, this, &MainWindow::onAllRatingsUploaded);
-    connect(m_setsModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
+    connect(m_worker, &Worker::ratingUploaded, m_ratingsModel, &RatingsModel::markUploaded);
+    connect(m_worker, &Worker::pendingUploadsFound, this, &MainWindow::onPendingUploadsFound);
+    connect(ui->ratingBasedCombo, &QComboBox::currentIndexChanged, this, std::bind(&MainWindow::scheduleRerate, this, RatingsMerger::RatingPart));
+    connect(ui->normalizationCombo, &QComboBox::currentIndexChanged, this, std::bind(&MainWindow::scheduleRerate, this, RatingsMerger::RatingPart));
+    connect(m_SLMetricsModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
         if (roles.isEmpty() || roles.contains(Qt::CheckStateRole))
-            updateRatingsFiler();
+            scheduleRerate(RatingsMerger::NotePart);
     });
-    connect(m_ratingsModel, &QAbstractItemModel::modelReset, this, &MainWindow::updateRatingsFiler);
-    m_worker->downloadSetsMTGAH();
+    connect(m_rerateTimer, &QTimer::timeout, this, &MainWindow::rerateNextChunk);
+    connect(ui->ratingsView->verticalScrollBar(), &QScrollBar::valueChanged, this, &MainWindow::rerateVisibleRows);
+    // rows moved under a running re-rating, start it over once the template is settled
+    connect(m_ratingsModel, &QAbstractItemModel::rowsInserted, this, std::bind(&MainWindow::scheduleRerate, this, 0), Qt::QueuedConnection);
+    connect(m_ratingsModel, &QAbstractItemModel::rowsRemoved, this, std::bind(&MainWindow::scheduleRerate, this, 0), Qt::QueuedConnection);
+    connect(m_ratingsModel, &QAbstractItemModel::modelReset, this, std::bind(&MainWindow::scheduleRerate, this, 0), Qt::QueuedConnection);
+    QMetaObject::invokeMethod(m_worker, &Worker::prewarmConnections);
+    // the snapshot fills the window right away, the sets and the template are then revalidated in the background
+    QMetaObject::invokeMethod(m_worker, &Worker::loadSnapshot);
+    QMetaObject::invokeMethod(m_worker, &Worker::downloadSetsMTGAH);
 }
 
 MainWindow::~MainWindow()
 {
+    m_workerThread->quit();
+    m_workerThread->wait();
     delete ui;
 }
 
@@ -375,6 +497,10 @@ void MainWindow::retranslateUi()
     ui->formatsCombo->setItemText(2, tr("Traditional Draft"));
     ui->formatsCombo->setItemText(3, tr("Sealed"));
     ui->formatsCombo->setItemText(4, tr("Traditional Sealed"));
+    ui->normalizationCombo->setItemText(SeventeenTable::MinMaxNormalization, tr("Linear (Min to Max)"));
+    ui->normalizationCombo->setItemText(SeventeenTable::PercentileNormalization, tr("Percentile Rank"));
+    ui->normalizationCombo->setItemText(SeventeenTable::ZScoreNormalization, tr("Standard Score"));
+    ui->normalizationCombo->setItemText(SeventeenTable::ShrinkageNormalization, tr("Shrunk by Games Played"));
     ui->retranslateUi(this);
     ui->errorLabel->setVisible(m_error != NoError);
     ui->retryBasicDownloadButton->setVisible(m_error & MTGAHSetsError);
@@ -391,43 +517,11 @@ void MainWindow::retranslateUi()
     ui->errorLabel->setText(errorStrings.join(QChar(QLatin1Char('\n'))));
     ui->ratingsView->update();
     SLcodes = QStringList(SLCount, QString());
-    SLcodes[SLseen_count] = tr("#S");
-    SLcodes[SLavg_seen] = tr("ALSA");
-    SLcodes[SLpick_count] = tr("#P");
-    SLcodes[SLavg_pick] = tr("ATA");
-    SLcodes[SLgame_count] = tr("#GP");
-    SLcodes[SLwin_rate] = tr("GPWR");
-    SLcodes[SLopening_hand_game_count] = tr("#OH");
-    SLcodes[SLopening_hand_win_rate] = tr("OHWR");
-    SLcodes[SLdrawn_game_count] = tr("#GD");
-    SLcodes[SLdrawn_win_rate] = tr("GDWR");
-    SLcodes[SLever_drawn_game_count] = tr("#GIH");
-    SLcodes[SLever_drawn_win_rate] = tr("GIHWR");
-    SLcodes[SLnever_drawn_game_count] = tr("#GND");
-    SLcodes[SLnever_drawn_win_rate] = tr("GNDWR");
-    SLcodes[SLdrawn_improvement_win_rate] = tr("IWD");
-
-    m_SLMetricsModel->item(SLseen_count)->setData(tr("Number Seen (%1)").arg(SLcodes.at(SLseen_count)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLavg_seen)->setData(tr("Average Last Seen At (%1)").arg(SLcodes.at(SLavg_seen)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLpick_count)->setData(tr("Number Picked (%1)").arg(SLcodes.at(SLpick_count)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLavg_pick)->setData(tr("Average Taken At (%1)").arg(SLcodes.at(SLavg_pick)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLgame_count)->setData(tr("Number of Games Played (%1)").arg(SLcodes.at(SLgame_count)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLwin_rate)->setData(tr("Games Played Win Rate (%1)").arg(SLcodes.at(SLwin_rate)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLopening_hand_game_count)
-            ->setData(tr("Number of Games in Opening Hand (%1)").arg(SLcodes.at(SLopening_hand_game_count)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLopening_hand_win_rate)
-            ->setData(tr("Opening Hand Win Rate (%1)").arg(SLcodes.at(SLopening_hand_win_rate)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLdrawn_game_count)->setData(tr("Number of Games Drawn (%1)").arg(SLcodes.at(SLdrawn_game_count)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLdrawn_win_rate)->setData(tr("Games Drawn Win Rate (%1)").arg(SLcodes.at(SLdrawn_win_rate)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLever_drawn_game_count)
-            ->setData(tr("Number of Games In Hand (%1)").arg(SLcodes.at(SLever_drawn_game_count)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLever_drawn_win_rate)->setData(tr("Games in Hand Win Rate (%1)").arg(SLcodes.at(SLever_drawn_win_rate)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLnever_drawn_game_count)
-            ->setData(tr("Number of Games Not Drawn (%1)").arg(SLcodes.at(SLnever_drawn_game_count)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLnever_drawn_win_rate)
-            ->setData(tr("Games Not Drawn Win Rate (%1)").arg(SLcodes.at(SLnever_drawn_win_rate)), Qt::DisplayRole);
-    m_SLMetricsModel->item(SLdrawn_improvement_win_rate)
-            ->setData(tr("Improvement When Drawn (%1)").arg(SLcodes.at(SLdrawn_improvement_win_rate)), Qt::DisplayRole);
+    for (int i = 0; i < SLCount; ++i) {
+        SLcodes[i] = QCoreApplication::translate("SLMetrics", slMetricDescriptors[i].code);
+        m_SLMetricsModel->item(i)->setData(QCoreApplication::translate("SLMetrics", slMetricDescriptors[i].description).arg(SLcodes.at(i)),
+                                           Qt::DisplayRole);
+    }
 }
 
 void MainWindow::setSetsSectionEnabled(bool enabled)
@@ -438,86 +532,22 @@ void MainWindow::setSetsSectionEnabled(bool enabled)
 
 void MainWindow::setAllSetsSelection(Qt::CheckState check)
 {
-    for (int i = 0, iEnd = m_setsModel->rowCount(); i < iEnd; ++i)
-        m_setsModel->item(i)->setCheckState(check);
-}
-
-QString MainWindow::commentString(const SeventeenCard &card) const
-{
-    QStringList result;
-    if (m_SLMetricsModel->index(SLseen_count, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLseen_count) + QLatin1Char(':') + locale().toString(card.seen_count));
-    if (m_SLMetricsModel->index(SLavg_seen, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLavg_seen) + QLatin1Char(':') + locale().toString(card.avg_seen, 'f', 2));
-    if (m_SLMetricsModel->index(SLpick_count, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLpick_count) + QLatin1Char(':') + locale().toString(card.pick_count));
-    if (m_SLMetricsModel->index(SLavg_pick, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLavg_pick) + QLatin1Char(':') + locale().toString(card.avg_pick, 'f', 2));
-    if (m_SLMetricsModel->index(SLgame_count, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLgame_count) + QLatin1Char(':') + locale().toString(card.game_count));
-    if (m_SLMetricsModel->index(SLwin_rate, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLwin_rate) + QLatin1Char(':') + locale().toString(card.win_rate * 100.0, 'f', 2) + locale().percent());
-    if (m_SLMetricsModel->index(SLopening_hand_game_count, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLopening_hand_game_count) + QLatin1Char(':') + locale().toString(card.opening_hand_game_count));
-    if (m_SLMetricsModel->index(SLopening_hand_win_rate, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLopening_hand_win_rate) + QLatin1Char(':') + locale().toString(card.opening_hand_win_rate * 100.0, 'f', 2)
-                      + locale().percent());
-    if (m_SLMetricsModel->index(SLdrawn_game_count, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLdrawn_game_count) + QLatin1Char(':') + locale().toString(card.drawn_game_count));
-    if (m_SLMetricsModel->index(SLdrawn_win_rate, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLdrawn_win_rate) + QLatin1Char(':') + locale().toString(card.drawn_win_rate * 100.0, 'f', 2) + locale().percent());
-    if (m_SLMetricsModel->index(SLever_drawn_game_count, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLever_drawn_game_count) + QLatin1Char(':') + locale().toString(card.ever_drawn_game_count));
-    if (m_SLMetricsModel->index(SLever_drawn_win_rate, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLever_drawn_win_rate) + QLatin1Char(':') + locale().toString(card.ever_drawn_win_rate * 100.0, 'f', 2)
-                      + locale().percent());
-    if (m_SLMetricsModel->index(SLnever_drawn_game_count, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLnever_drawn_game_count) + QLatin1Char(':') + locale().toString(card.never_drawn_game_count));
-    if (m_SLMetricsModel->index(SLnever_drawn_win_rate, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLnever_drawn_win_rate) + QLatin1Char(':') + locale().toString(card.never_drawn_win_rate * 100.0, 'f', 2)
-                      + locale().percent());
-    if (m_SLMetricsModel->index(SLdrawn_improvement_win_rate, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
-        result.append(SLcodes.at(SLdrawn_improvement_win_rate) + QLatin1Char(':') + locale().toString(card.drawn_improvement_win_rate * 100.0, 'f', 2)
-                      + locale().percent());
-    return result.join(QLatin1Char(' '));
-}
-
-double MainWindow::ratingValue(const SeventeenCard &card) const
-{
-    switch (ui->ratingBasedCombo->currentData().toInt()) {
-    case SLseen_count:
-        return card.seen_count;
-    case SLavg_seen:
-        return card.avg_seen;
-    case SLpick_count:
-        return card.pick_count;
-    case SLavg_pick:
-        return card.avg_pick;
-    case SLgame_count:
-        return card.game_count;
-    case SLwin_rate:
-        return card.win_rate;
-    case SLopening_hand_game_count:
-        return card.opening_hand_game_count;
-    case SLopening_hand_win_rate:
-        return card.opening_hand_win_rate;
-    case SLdrawn_game_count:
-        return card.drawn_game_count;
-    case SLdrawn_win_rate:
-        return card.drawn_win_rate;
-    case SLever_drawn_game_count:
-        return card.ever_drawn_game_count;
-    case SLever_drawn_win_rate:
-        return card.ever_drawn_win_rate;
-    case SLnever_drawn_game_count:
-        return card.never_drawn_game_count;
-    case SLnever_drawn_win_rate:
-        return card.never_drawn_win_rate;
-    case SLdrawn_improvement_win_rate:
-        return card.drawn_improvement_win_rate;
-    default:
-        return 0;
+    m_setsModel->setAllChecked(check == Qt::Checked);
+}
+
+SeventeenTable::Normalization MainWindow::selectedNormalization() const
+{
+    return static_cast<SeventeenTable::Normalization>(ui->normalizationCombo->currentData().toInt());
+}
+
+quint32 MainWindow::selectedNoteMetrics() const
+{
+    quint32 result = 0;
+    for (int i = 0; i < SLCount; ++i) {
+        if (m_SLMetricsModel->index(i, 0).data(Qt::CheckStateRole).toInt() == Qt::Checked)
+            result |= slMetricBit(i);
     }
+    return result;
 }
 
 void MainWindow::toggleLoginLogoutButtons()
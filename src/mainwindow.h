@@ -13,16 +13,24 @@
 
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
+#include "seventeenlandsstats.h"
+#include "slmetrics.h"
+#include <QBitArray>
 #include <QMultiHash>
 #include <QWidget>
 namespace Ui {
 class MainWindow;
 }
 class QStandardItemModel;
+class SetsModel;
+class SetFilterProxyModel;
+class FetchChunkProxyModel;
 class Worker;
 class RatingsModel;
 class QSortFilterProxyModel;
-class SeventeenCard;
+class QThread;
+class QTimer;
+class RatingsStore;
 class MainWindow : public QWidget
 {
     Q_OBJECT
@@ -40,37 +48,28 @@ protected:
 
 private:
     CurrentErrors m_error;
-    QStandardItemModel *m_setsModel;
+    SetsModel *m_setsModel;
     QStandardItemModel *m_SLMetricsModel;
     RatingsModel *m_ratingsModel;
+    SetFilterProxyModel *m_setFilterProxy;
     QSortFilterProxyModel *m_ratingsProxy;
+    // the view sees the top of the sorted rows and fetches the rest as it scrolls
+    FetchChunkProxyModel *m_fetchProxy;
     Worker *m_worker;
+    QThread *m_workerThread;
+    // statistics of the downloaded sets, changing the metric or the note recomputes from here
+    SeventeenLandsStats m_seventeenLandsStats;
+    QBitArray m_reratePending;
+    int m_rerateCursor;
+    int m_rerateParts;
+    QTimer *m_rerateTimer;
     Ui::MainWindow *ui;
     void setSetsSectionEnabled(bool enabled);
     void setAllSetsSelection(Qt::CheckState check);
-    enum SLMetrics {
-        SLseen_count,
-        SLavg_seen,
-        SLpick_count,
-        SLavg_pick,
-        SLgame_count,
-        SLwin_rate,
-        SLopening_hand_game_count,
-        SLopening_hand_win_rate,
-        SLdrawn_game_count,
-        SLdrawn_win_rate,
-        SLever_drawn_game_count,
-        SLever_drawn_win_rate,
-        SLnever_drawn_game_count,
-        SLnever_drawn_win_rate,
-        SLdrawn_improvement_win_rate
-
-        ,
-        SLCount
-    };
     QStringList SLcodes;
-    QString commentString(const SeventeenCard &card) const;
-    double ratingValue(const SeventeenCard &card) const;
+    quint32 selectedNoteMetrics() const;
+    SeventeenTable::Normalization selectedNormalization() const;
+    void applyRerate(const QVector<int> &rows);
 private slots:
     void toggleLoginLogoutButtons();
     void doLogin();
@@ -79,7 +78,7 @@ private slots:
     void doMtgahUpload();
     void fillSets(const QStringList &sets);
     void fillSetNames(const QHash<QString, QString> &setNames);
-    void onDownloaded17LRatings(const QString &set, const QSet<SeventeenCard> &ratings);
+    void onDownloaded17LRatings(const QString &set, const SeventeenTable &ratings);
     void onDownloadedAll17LRatings();
     void onDownload17LRatingsProgress(int progress);
     void fillMetrics();
@@ -87,6 +86,8 @@ private slots:
     void disableSetsSection() { setSetsSectionEnabled(false); }
     void onLogin();
     void onLoginError();
+    void onSessionRestored(const QString &userName);
+    void onSessionExpired();
     void onLogout();
     void onLogoutError();
     void onMTGAHSetsError();
@@ -96,11 +97,16 @@ private slots:
     void selectNoSets() { setAllSetsSelection(Qt::Unchecked); }
     void retrySetsDownload();
     void retryTemplateDownload();
-    void onCustomRatingsTemplateDownloaded();
-    void updateRatingsFiler();
+    void onCustomRatingsTemplateDownloaded(const RatingsStore &ratings);
+    void onCustomRatingsTemplateUnchanged();
     void onRatingsUploadMaxProgress(int maxRange);
     void onRatingsUploadProgress(int progress);
     void onAllRatingsUploaded();
+    void onPendingUploadsFound(int count);
+    void scheduleRerate(int updateParts);
+    void rerateVisibleRows();
+    void rerateNextChunk();
+    void finishRerate();
 };
 Q_DECLARE_OPERATORS_FOR_FLAGS(MainWindow::CurrentErrors);
 #endif
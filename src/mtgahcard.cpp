@@ -1,5 +1,25 @@
 #include "mtgahcard.h"
+#include "stringpool.h"
 MtgahCard::MtgahCard()
     : id_arena(0)
+    , nameId(-1)
+    , setId(-1)
     , rating(-1)
+    , serverRating(-1)
 { }
+
+void MtgahCard::markClean()
+{
+    serverRating = rating;
+    serverNote = note;
+}
+
+void MtgahCard::setName(const QString &cardName)
+{
+    name = StringPool::shared(cardName, &nameId);
+}
+
+void MtgahCard::setSet(const QString &setCode)
+{
+    set = StringPool::shared(setCode, &setId);
+}
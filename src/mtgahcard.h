@@ -13,6 +13,7 @@
 
 #ifndef MTGAHCARD_H
 #define MTGAHCARD_H
+#include <QMetaType>
 #include <QString>
 class MtgahCard
 {
@@ -20,11 +21,23 @@ public:
     MtgahCard();
     MtgahCard(const MtgahCard &other) = default;
     MtgahCard &operator=(const MtgahCard &other) = default;
+    bool isRatingDirty() const { return rating != serverRating; }
+    bool isNoteDirty() const { return note != serverNote; }
+    bool isDirty() const { return isRatingDirty() || isNoteDirty(); }
+    void markClean();
+    // store the pooled copy and its id, see StringPool
+    void setName(const QString &cardName);
+    void setSet(const QString &setCode);
     int id_arena;
     QString name;
     QString set;
+    int nameId;
+    int setId;
     char rating;
     QString note;
+    char serverRating;
+    QString serverNote;
 };
+Q_DECLARE_METATYPE(MtgahCard)
 
 #endif
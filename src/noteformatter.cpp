@@ -0,0 +1,205 @@
+#include "noteformatter.h"
+#include "seventeencube.h"
+#include <QCoreApplication>
+#include <cmath>
+namespace {
+const quint64 powersOf10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+const int maxFastPrecision = 9;
+
+bool singleChar(const QString &symbol, QChar &result)
+{
+    if (symbol.size() != 1)
+        return false;
+    result = symbol.at(0);
+    return true;
+}
+}
+
+NoteFormatter::NoteFormatter(const QLocale &locale, const QStringList &codes, quint32 noteMetrics)
+    : m_locale(locale)
+    , m_percent(locale.percent())
+    , m_fastIntegers(false)
+    , m_fastReals(false)
+    , m_reserve(0)
+    , m_cubeReserve(0)
+    , m_cube(nullptr)
+    , m_cubeMetric(0)
+    , m_bestCode(QCoreApplication::translate("NoteFormatter", "Best"))
+{
+    Q_ASSERT(codes.size() >= SLCount);
+    for (int i = 0; i < SLCount; ++i) {
+        if (!(noteMetrics & slMetricBit(i)))
+            continue;
+        const SLMetricDescriptor &descriptor = slMetricDescriptors[i];
+        Field field;
+        field.metric = i;
+        field.prefix = m_layout.isEmpty() ? codes.at(i) + QLatin1Char(':') : QLatin1Char(' ') + codes.at(i) + QLatin1Char(':');
+        field.type = descriptor.type;
+        field.percent = descriptor.percent;
+        field.precision = descriptor.precision;
+        m_layout.append(field);
+        m_reserve += field.prefix.size() + 16 + (field.percent ? m_percent.size() : 0);
+    }
+    const bool groupSeparatorOk = (m_locale.numberOptions() & QLocale::OmitGroupSeparator) || singleChar(m_locale.groupSeparator(), m_groupSeparator);
+    if (m_locale.zeroDigit() == QLatin1String("0") && groupSeparatorOk && singleChar(m_locale.negativeSign(), m_negativeSign)) {
+        m_fastIntegers = fastIntegersMatch();
+        m_fastReals = singleChar(m_locale.decimalPoint(), m_decimalPoint) && fastRealsMatch();
+    }
+}
+
+// the fast paths only handle the common western number layout, make sure the locale uses it
+bool NoteFormatter::fastIntegersMatch() const
+{
+    const qint64 samples[] = {0, 7, -7, 12, 123, 1234, -1234, 12345, 123456, 1234567, 12345678, -123456789};
+    for (qint64 sample : samples) {
+        QString fastResult;
+        appendInteger(fastResult, sample);
+        if (fastResult != m_locale.toString(sample))
+            return false;
+    }
+    return true;
+}
+
+bool NoteFormatter::fastRealsMatch() const
+{
+    const double samples[] = {0.0, 0.1, 1.0, 1.23, -1.23, 12.345678, 123.4, 1234.56, -1234.56, 12345.67, 1234567.89};
+    for (double sample : samples) {
+        for (int precision = 0; precision <= 3; ++precision) {
+            QString fastResult;
+            appendReal(fastResult, sample, precision);
+            if (fastResult != m_locale.toString(sample, 'f', precision))
+                return false;
+        }
+    }
+    return true;
+}
+
+QString NoteFormatter::format(const SeventeenTable &table, int row) const
+{
+    QString result;
+    format(table, row, result);
+    return result;
+}
+
+void NoteFormatter::format(const SeventeenTable &table, int row, QString &result) const
+{
+    result.clear();
+    result.reserve(m_reserve + m_cubeReserve);
+    for (const Field &field : m_layout) {
+        result.append(field.prefix);
+        if (field.type == SLIntegerMetric) {
+            appendInteger(result, table.intValue(field.metric, row));
+        } else if (field.percent) {
+            appendReal(result, table.doubleValue(field.metric, row) * 100.0, field.precision);
+            result.append(m_percent);
+        } else {
+            appendReal(result, table.doubleValue(field.metric, row), field.precision);
+        }
+    }
+    if (m_cube)
+        appendCubeSummary(result, table.name(row));
+}
+
+void NoteFormatter::setCube(const SeventeenCube *cube, const QString &set, const QString &format, int metric)
+{
+    m_cube = cube;
+    m_cubeSet = set;
+    m_cubeFormat = format;
+    m_cubeMetric = metric;
+    m_cubeReserve = m_cube ? 16 * (SeventeenCube::formats().size() + 1) : 0;
+}
+
+void NoteFormatter::appendCubeSummary(QString &result, const QString &name) const
+{
+    QString colors;
+    double value = 0.0;
+    if (m_cube->bestArchetype(m_cubeSet, m_cubeFormat, name, m_cubeMetric, SeventeenCube::DefaultMinGames, colors, value)) {
+        if (!result.isEmpty())
+            result.append(QLatin1Char(' '));
+        result.append(m_bestCode);
+        result.append(QLatin1Char(':'));
+        result.append(colors);
+        result.append(QLatin1Char(':'));
+        appendMetric(result, m_cubeMetric, value);
+    }
+    for (const QString &format : SeventeenCube::formats()) {
+        if (format == m_cubeFormat)
+            continue;
+        const SeventeenTable *table = m_cube->slice(m_cubeSet, format);
+        if (!table)
+            continue;
+        const int row = table->indexOf(name);
+        if (row < 0)
+            continue;
+        if (!result.isEmpty())
+            result.append(QLatin1Char(' '));
+        result.append(SeventeenCube::formatCode(format));
+        result.append(QLatin1Char(':'));
+        appendMetric(result, m_cubeMetric, table->value(m_cubeMetric, row));
+    }
+}
+
+void NoteFormatter::appendMetric(QString &result, int metric, double value) const
+{
+    const SLMetricDescriptor &descriptor = slMetricDescriptors[metric];
+    if (descriptor.type == SLIntegerMetric) {
+        appendInteger(result, qRound64(value));
+    } else if (descriptor.percent) {
+        appendReal(result, value * 100.0, descriptor.precision);
+        result.append(m_percent);
+    } else {
+        appendReal(result, value, descriptor.precision);
+    }
+}
+
+void NoteFormatter::appendInteger(QString &result, qint64 value) const
+{
+    if (!m_fastIntegers) {
+        result.append(m_locale.toString(value));
+        return;
+    }
+    const bool negative = value < 0;
+    appendDigits(result, negative, negative ? 0 - static_cast<quint64>(value) : static_cast<quint64>(value), 0, 0);
+}
+
+void NoteFormatter::appendReal(QString &result, double value, int precision) const
+{
+    if (m_fastReals && precision <= maxFastPrecision && std::isfinite(value)) {
+        const double scaled = std::fabs(value) * powersOf10[precision];
+        // values too close to a rounding tie are left to QLocale so the rounding is always identical
+        if (scaled < 1e9 && std::fabs(scaled - std::floor(scaled) - 0.5) > 1e-6) {
+            const quint64 rounded = static_cast<quint64>(scaled + 0.5);
+            if (rounded != 0 || value >= 0.0) {
+                appendDigits(result, value < 0.0, rounded / powersOf10[precision], rounded % powersOf10[precision], precision);
+                return;
+            }
+        }
+    }
+    result.append(m_locale.toString(value, 'f', precision));
+}
+
+void NoteFormatter::appendDigits(QString &result, bool negative, quint64 integerPart, quint64 fraction, int precision) const
+{
+    QChar digits[48];
+    int pos = 48;
+    for (int i = 0; i < precision; ++i) {
+        digits[--pos] = QLatin1Char(static_cast<char>('0' + fraction % 10));
+        fraction /= 10;
+    }
+    if (precision > 0)
+        digits[--pos] = m_decimalPoint;
+    const bool grouping = !(m_locale.numberOptions() & QLocale::OmitGroupSeparator);
+    int groupCount = 0;
+    do {
+        if (grouping && groupCount == 3) {
+            digits[--pos] = m_groupSeparator;
+            groupCount = 0;
+        }
+        digits[--pos] = QLatin1Char(static_cast<char>('0' + integerPart % 10));
+        integerPart /= 10;
+        ++groupCount;
+    } while (integerPart != 0);
+    if (negative)
+        digits[--pos] = m_negativeSign;
+    result.append(digits + pos, 48 - pos);
+}
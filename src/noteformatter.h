@@ -0,0 +1,67 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+#ifndef NOTEFORMATTER_H
+#define NOTEFORMATTER_H
+#include "seventeentable.h"
+class SeventeenCube;
+#include <QLocale>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+// Formats the 17Lands note of a card, producing the same text as joining "CODE:value" pairs
+// formatted by QLocale. The layout of the selected metrics and the locale symbols are computed once;
+// numbers are written straight into a reserved buffer unless the locale needs QLocale's own formatting.
+class NoteFormatter
+{
+public:
+    NoteFormatter(const QLocale &locale, const QStringList &codes, quint32 noteMetrics);
+    QString format(const SeventeenTable &table, int row) const;
+    void format(const SeventeenTable &table, int row, QString &result) const;
+    // also append the best two color archetype in format and the value of metric in the other formats of the cube
+    void setCube(const SeventeenCube *cube, const QString &set, const QString &format, int metric);
+
+private:
+    struct Field
+    {
+        int metric;
+        QString prefix;
+        SLMetricType type;
+        bool percent;
+        int precision;
+    };
+    void appendCubeSummary(QString &result, const QString &name) const;
+    void appendMetric(QString &result, int metric, double value) const;
+    void appendInteger(QString &result, qint64 value) const;
+    void appendReal(QString &result, double value, int precision) const;
+    void appendDigits(QString &result, bool negative, quint64 integerPart, quint64 fraction, int precision) const;
+    bool fastIntegersMatch() const;
+    bool fastRealsMatch() const;
+    QVector<Field> m_layout;
+    QLocale m_locale;
+    QString m_percent;
+    QChar m_decimalPoint;
+    QChar m_groupSeparator;
+    QChar m_negativeSign;
+    bool m_fastIntegers;
+    bool m_fastReals;
+    int m_reserve;
+    int m_cubeReserve;
+    const SeventeenCube *m_cube;
+    QString m_cubeSet;
+    QString m_cubeFormat;
+    int m_cubeMetric;
+    QString m_bestCode;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "ratingsmerger.h"
+#include "seventeenlandsstats.h"
+#include "tracer.h"
+namespace {
+// cards of the template carry the pool id of their name, the join never hashes the string for them
+int tableRow(const SeventeenTable &table, const MtgahCard &card)
+{
+    return card.nameId >= 0 ? table.indexOfNameId(card.nameId) : table.indexOf(card.name);
+}
+}
+
+RatingUpdate::RatingUpdate()
+    : RatingUpdate(-1, -1, QString())
+{ }
+
+RatingUpdate::RatingUpdate(int rw, char rtg, const QString &nt)
+    : row(rw)
+    , rating(rtg)
+    , note(nt)
+{ }
+
+QVector<RatingUpdate> RatingsMerger::merge(const RatingsStore &store, const QString &set, const SeventeenTable &ratings, int ratingMetric,
+                                           const NoteFunction &note, SeventeenTable::Normalization normalization)
+{
+    QVector<RatingUpdate> result;
+    const std::pair<int, int> range = store.setRange(set);
+    if (ratings.isEmpty() || range.first == range.second || ratingMetric < 0 || ratingMetric >= SLCount)
+        return result;
+    // the join and the notes run as separate passes so they can be timed apart
+    QVector<int> ratingsRows;
+    {
+        TraceSpan mergeSpan("merge", "cpu", set);
+        const QVector<char> normalizedRatings = ratings.normalizedRatings(ratingMetric, normalization);
+        ratingsRows.reserve(range.second - range.first);
+        result.reserve(range.second - range.first);
+        for (int i = range.first; i < range.second; ++i) {
+            const int ratingsRow = tableRow(ratings, store.at(i));
+            if (ratingsRow < 0)
+                continue;
+            ratingsRows.append(ratingsRow);
+            result.append(RatingUpdate(i, normalizedRatings.at(ratingsRow), QString()));
+        }
+        mergeSpan.setCards(result.size());
+    }
+    TraceSpan noteSpan("note formatting", "cpu", set, ratingsRows.size());
+    for (int i = 0, iEnd = ratingsRows.size(); i < iEnd; ++i)
+        result[i].note = note(ratings, ratingsRows.at(i));
+    return result;
+}
+
+QVector<RatingUpdate> RatingsMerger::rerate(const RatingsStore &store, const QVector<int> &rows, const SeventeenLandsStats &stats, int ratingMetric,
+                                            SeventeenTable::Normalization normalization, int updateParts, const NoteFunction &note)
+{
+    QVector<RatingUpdate> result;
+    if ((updateParts & RatingPart) && (ratingMetric < 0 || ratingMetric >= SLCount))
+        return result;
+    result.reserve(rows.size());
+    TraceSpan rerateSpan("rerate", "cpu", QString(), rows.size());
+    // rows come grouped by set, the table and its ratings are looked up again only when the set changes
+    int currentSetId = -1;
+    QString currentSet;
+    SeventeenTable table;
+    QVector<char> normalizedRatings;
+    for (const int row : rows) {
+        const MtgahCard &card = store.at(row);
+        if ((card.setId >= 0 ? card.setId != currentSetId : card.set != currentSet) || table.isEmpty()) {
+            currentSetId = card.setId;
+            currentSet = card.set;
+            table = stats.table(currentSet);
+            if (updateParts & RatingPart)
+                normalizedRatings = stats.ratings(currentSet, ratingMetric, normalization);
+        }
+        const int ratingsRow = tableRow(table, card);
+        if (ratingsRow < 0)
+            continue;
+        result.append(RatingUpdate(row, (updateParts & RatingPart) ? normalizedRatings.at(ratingsRow) : card.rating,
+                                   (updateParts & NotePart) ? note(table, ratingsRow) : card.note));
+    }
+    return result;
+}
+
+void RatingsMerger::apply(RatingsStore &store, const QVector<RatingUpdate> &updates)
+{
+    for (const RatingUpdate &update : updates) {
+        MtgahCard &card = store.card(update.row);
+        card.rating = update.rating;
+        card.note = update.note;
+    }
+}
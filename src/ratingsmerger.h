@@ -0,0 +1,48 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+#ifndef RATINGSMERGER_H
+#define RATINGSMERGER_H
+#include "ratingsstore.h"
+#include "seventeentable.h"
+#include <QString>
+#include <QVector>
+#include <functional>
+class RatingUpdate
+{
+public:
+    RatingUpdate();
+    RatingUpdate(int row, char rating, const QString &note);
+    int row;
+    char rating;
+    QString note;
+};
+Q_DECLARE_TYPEINFO(RatingUpdate, Q_RELOCATABLE_TYPE);
+
+// Joins the 17Lands statistics of a set with the rows of that set in the template.
+// The work is proportional to the size of the set, not of the whole template.
+class SeventeenLandsStats;
+class RatingsMerger
+{
+public:
+    enum UpdatePart { RatingPart = 0x1, NotePart = 0x2 };
+    typedef std::function<QString(const SeventeenTable &, int)> NoteFunction;
+    static QVector<RatingUpdate> merge(const RatingsStore &store, const QString &set, const SeventeenTable &ratings, int ratingMetric,
+                                       const NoteFunction &note, SeventeenTable::Normalization normalization = SeventeenTable::MinMaxNormalization);
+    // computes the given rows again from statistics already in memory, the parts not in updateParts keep the value in the store
+    static QVector<RatingUpdate> rerate(const RatingsStore &store, const QVector<int> &rows, const SeventeenLandsStats &stats, int ratingMetric,
+                                        SeventeenTable::Normalization normalization, int updateParts, const NoteFunction &note);
+    static void apply(RatingsStore &store, const QVector<RatingUpdate> &updates);
+};
+
+#endif
@@ -1,16 +1,19 @@
 #include "ratingsmodel.h"
-#include "mtgahcard.h"
+#include "tracer.h"
+#include <QFont>
+#include <algorithm>
+#include <numeric>
+#include <vector>
 
 RatingsModel::RatingsModel(QObject *parent)
     : QAbstractTableModel(parent)
-    , m_ratingsTemplate(nullptr)
 { }
 
 int RatingsModel::rowCount(const QModelIndex &parent) const
 {
-    if (parent.isValid() || !m_ratingsTemplate)
+    if (parent.isValid())
         return 0;
-    return m_ratingsTemplate->size();
+    return m_ratingsTemplate.size();
 }
 
 int RatingsModel::columnCount(const QModelIndex &parent) const
@@ -22,22 +25,55 @@ int RatingsModel::columnCount(const QModelIndex &parent) const
 
 QVariant RatingsModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.parent().isValid() || role != Qt::DisplayRole || index.row() >= rowCount())
+    if (!index.isValid() || index.parent().isValid() || index.row() >= rowCount())
+        return QVariant();
+    const MtgahCard &card = m_ratingsTemplate.at(index.row());
+    if (role == DirtyRole || role == Qt::FontRole) {
+        bool dirty;
+        switch (index.column()) {
+        case rmcRating:
+            dirty = card.isRatingDirty();
+            break;
+        case rmcNote:
+            dirty = card.isNoteDirty();
+            break;
+        default:
+            dirty = card.isDirty();
+            break;
+        }
+        if (role == DirtyRole)
+            return dirty;
+        if (!dirty || (index.column() != rmcRating && index.column() != rmcNote))
+            return QVariant();
+        QFont dirtyFont;
+        dirtyFont.setBold(true);
+        return dirtyFont;
+    }
+    if (role == SetIdRole)
+        return card.setId;
+    if (role == SortRole) {
+        switch (index.column()) {
+        case rmcArenaId:
+            return card.id_arena;
+        case rmcRating:
+            return qint64(card.rating) * (qint64(1) << 32) + index.row();
+        default:
+            return collationRank(index.column(), index.row());
+        }
+    }
+    if (role != Qt::DisplayRole)
         return QVariant();
-    auto i = m_ratingsTemplate->begin();
-    for (int j = index.row(); j > 0; --j)
-        ++i;
     switch (index.column()) {
     case rmcSet:
-        return i->set;
+        return card.set;
     case rmcName:
-        return i->name;
+        return card.name;
     case rmcArenaId:
-        return i->id_arena;
+        return card.id_arena;
     case rmcRating:
-        return static_cast<int>(i->rating);
+        return static_cast<int>(card.rating);
     case rmcNote:
-        return i->note;
+        return card.note;
     default:
         return QVariant();
     }
@@ -65,11 +101,72 @@ QVariant RatingsModel::headerData(int section, Qt::Orientation orientation, int
     }
 }
 
-void RatingsModel::setRatingsTemplate(QMultiHash<QString, MtgahCard> *tmplt)
+void RatingsModel::setRatingsTemplate(const RatingsStore &tmplt)
 {
-    beginResetModel();
+    TraceSpan publishSpan("model publish", "cpu", QString(), tmplt.size());
+    if (m_ratingsTemplate.isEmpty() || tmplt.isEmpty()) {
+        beginResetModel();
+        m_ratingsTemplate = tmplt;
+        invalidateSortKeys();
+        endResetModel();
+        return;
+    }
+    // both stores are sorted the same way so they can be diffed in a single merge pass
+    int changedFirst = -1;
+    int changedLast = -1;
+    const auto flushChanged = [this, &changedFirst, &changedLast]() {
+        if (changedFirst < 0)
+            return;
+        invalidateSortKeys(-1, changedFirst, changedLast);
+        emit dataChanged(index(changedFirst, 0), index(changedLast, rmcCount - 1));
+        changedFirst = -1;
+    };
+    int oldRow = 0;
+    int newRow = 0;
+    const int newSize = tmplt.size();
+    while (oldRow < m_ratingsTemplate.size() || newRow < newSize) {
+        const int oldSize = m_ratingsTemplate.size();
+        if (oldRow < oldSize && (newRow >= newSize || RatingsStore::lessThan(m_ratingsTemplate.at(oldRow), tmplt.at(newRow)))) {
+            int runEnd = oldRow + 1;
+            while (runEnd < oldSize && (newRow >= newSize || RatingsStore::lessThan(m_ratingsTemplate.at(runEnd), tmplt.at(newRow))))
+                ++runEnd;
+            flushChanged();
+            beginRemoveRows(QModelIndex(), oldRow, runEnd - 1);
+            m_ratingsTemplate.removeCards(oldRow, runEnd - oldRow);
+            removeSortKeys(oldRow, runEnd - oldRow);
+            endRemoveRows();
+        } else if (newRow < newSize && (oldRow >= oldSize || RatingsStore::lessThan(tmplt.at(newRow), m_ratingsTemplate.at(oldRow)))) {
+            QVector<MtgahCard> insertedCards;
+            for (; newRow < newSize && (oldRow >= oldSize || RatingsStore::lessThan(tmplt.at(newRow), m_ratingsTemplate.at(oldRow))); ++newRow)
+                insertedCards.append(tmplt.at(newRow));
+            flushChanged();
+            beginInsertRows(QModelIndex(), oldRow, oldRow + insertedCards.size() - 1);
+            m_ratingsTemplate.insertCards(oldRow, insertedCards);
+            insertSortKeys(oldRow, insertedCards.size());
+            endInsertRows();
+            oldRow += insertedCards.size();
+        } else {
+            const MtgahCard &oldCard = m_ratingsTemplate.at(oldRow);
+            const MtgahCard &newCard = tmplt.at(newRow);
+            if (oldCard.name != newCard.name || oldCard.rating != newCard.rating || oldCard.note != newCard.note
+                || oldCard.serverRating != newCard.serverRating || oldCard.serverNote != newCard.serverNote) {
+                m_ratingsTemplate.card(oldRow) = newCard;
+                if (changedFirst < 0)
+                    changedFirst = oldRow;
+                changedLast = oldRow;
+            }
+            ++oldRow;
+            ++newRow;
+        }
+    }
+    flushChanged();
+    // same cards in the same rows, only the indexes of the store are refreshed
     m_ratingsTemplate = tmplt;
-    endResetModel();
+}
+
+const RatingsStore &RatingsModel::ratingsTemplate() const
+{
+    return m_ratingsTemplate;
 }
 
 bool RatingsModel::setData(const QModelIndex &index, const QVariant &value, int role)
@@ -78,23 +175,173 @@ bool RatingsModel::setData(const QModelIndex &index, const QVariant &value, int
         role = Qt::DisplayRole;
     if (!index.isValid() || index.parent().isValid() || role != Qt::DisplayRole || index.row() >= rowCount())
         return false;
-    auto i = m_ratingsTemplate->begin();
-    for (int j = index.row(); j > 0; --j)
-        ++i;
+    MtgahCard &card = m_ratingsTemplate.card(index.row());
     switch (index.column()) {
     case rmcRating:
-        i->rating = static_cast<decltype(i->rating)>(value.toInt());
+        card.rating = static_cast<decltype(card.rating)>(value.toInt());
         break;
     case rmcNote:
-        i->note = value.toString();
+        card.note = value.toString();
+        invalidateSortKeys(rmcNote, index.row(), index.row());
         break;
     default:
         return false;
     }
-    emit dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole});
+    emit dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole, Qt::FontRole, DirtyRole});
     return true;
 }
 
+void RatingsModel::applyUpdates(const QVector<RatingUpdate> &updates)
+{
+    if (updates.isEmpty())
+        return;
+    TraceSpan publishSpan("model publish", "cpu", QString(), updates.size());
+    RatingsMerger::apply(m_ratingsTemplate, updates);
+    int firstRow = updates.constFirst().row;
+    int lastRow = firstRow;
+    for (const RatingUpdate &update : updates) {
+        firstRow = std::min(firstRow, update.row);
+        lastRow = std::max(lastRow, update.row);
+    }
+    invalidateSortKeys(rmcNote, firstRow, lastRow);
+    emit dataChanged(index(firstRow, rmcRating), index(lastRow, rmcNote), {Qt::DisplayRole, Qt::EditRole, Qt::FontRole, DirtyRole});
+}
+
+void RatingsModel::markUploaded(const MtgahCard &card)
+{
+    const int row = m_ratingsTemplate.rowForArenaId(card.id_arena);
+    if (row < 0)
+        return;
+    m_ratingsTemplate.card(row).serverRating = card.rating;
+    m_ratingsTemplate.card(row).serverNote = card.note;
+    emit dataChanged(index(row, 0), index(row, rmcCount - 1), {Qt::FontRole, DirtyRole});
+}
+
+void RatingsModel::invalidateSortKeys(int column)
+{
+    if (column >= 0) {
+        m_collationOrders[column] = CollationOrder();
+        return;
+    }
+    for (CollationOrder &order : m_collationOrders)
+        order = CollationOrder();
+}
+
+// rows keep their index, only their ranks are dropped and computed again on demand
+void RatingsModel::invalidateSortKeys(int column, int firstRow, int lastRow)
+{
+    for (int i = column >= 0 ? column : 0, iEnd = column >= 0 ? column + 1 : rmcCount; i < iEnd; ++i) {
+        CollationOrder &order = m_collationOrders[i];
+        if (order.rows.isEmpty())
+            continue;
+        int kept = 0;
+        for (int j = 0, jEnd = order.rows.size(); j < jEnd; ++j) {
+            const int row = order.rows.at(j);
+            if (row >= firstRow && row <= lastRow) {
+                order.ranks[row] = -1;
+                continue;
+            }
+            order.rows[kept] = row;
+            std::swap(order.keys[kept], order.keys[j]);
+            ++kept;
+        }
+        order.rows.resize(kept);
+        order.keys.erase(order.keys.begin() + kept, order.keys.end());
+    }
+}
+
+// the inserted rows are ranked on demand, the other rows keep their keys and their order
+void RatingsModel::insertSortKeys(int firstRow, int count)
+{
+    for (CollationOrder &order : m_collationOrders) {
+        if (order.ranks.isEmpty())
+            continue;
+        order.ranks.insert(firstRow, count, -1);
+        for (int &row : order.rows) {
+            if (row >= firstRow)
+                row += count;
+        }
+    }
+}
+
+void RatingsModel::removeSortKeys(int firstRow, int count)
+{
+    const int lastRow = firstRow + count - 1;
+    for (CollationOrder &order : m_collationOrders) {
+        if (order.ranks.isEmpty())
+            continue;
+        int kept = 0;
+        for (int j = 0, jEnd = order.rows.size(); j < jEnd; ++j) {
+            const int row = order.rows.at(j);
+            if (row >= firstRow && row <= lastRow)
+                continue;
+            order.rows[kept] = row > lastRow ? row - count : row;
+            std::swap(order.keys[kept], order.keys[j]);
+            ++kept;
+        }
+        order.rows.resize(kept);
+        order.keys.erase(order.keys.begin() + kept, order.keys.end());
+        order.ranks.remove(firstRow, count);
+        for (int i = 0; i < kept; ++i)
+            order.ranks[order.rows.at(i)] = i;
+    }
+}
+
+// computes the sort keys once per change instead of collating the strings in every comparison of the sort
+int RatingsModel::collationRank(int column, int row) const
+{
+    CollationOrder &order = m_collationOrders[column];
+    const int count = m_ratingsTemplate.size();
+    if (order.ranks.size() != count) {
+        order = CollationOrder();
+        order.ranks.fill(-1, count);
+    }
+    if (order.ranks.at(row) >= 0)
+        return order.ranks.at(row);
+    // ties are broken by row so merging gives the same order as ranking every row at once
+    const auto lessThan = [](const QCollatorSortKey &keyA, int rowA, const QCollatorSortKey &keyB, int rowB) {
+        const int comparison = keyA.compare(keyB);
+        return comparison < 0 || (comparison == 0 && rowA < rowB);
+    };
+    QVector<int> newRows;
+    std::vector<QCollatorSortKey> newKeys;
+    for (int i = 0; i < count; ++i) {
+        if (order.ranks.at(i) >= 0)
+            continue;
+        newRows.append(i);
+        newKeys.push_back(m_collator.sortKey(data(index(i, column), Qt::DisplayRole).toString()));
+    }
+    QVector<int> newOrder(newRows.size());
+    std::iota(newOrder.begin(), newOrder.end(), 0);
+    std::sort(newOrder.begin(), newOrder.end(),
+              [&](int a, int b) { return lessThan(newKeys[a], newRows.at(a), newKeys[b], newRows.at(b)); });
+    QVector<int> mergedRows;
+    std::vector<QCollatorSortKey> mergedKeys;
+    mergedRows.reserve(order.rows.size() + newRows.size());
+    mergedKeys.reserve(order.rows.size() + newRows.size());
+    int oldPos = 0;
+    int newPos = 0;
+    while (oldPos < order.rows.size() || newPos < newOrder.size()) {
+        const bool takeNew = newPos < newOrder.size()
+                && (oldPos >= order.rows.size()
+                    || lessThan(newKeys[newOrder.at(newPos)], newRows.at(newOrder.at(newPos)), order.keys[oldPos], order.rows.at(oldPos)));
+        if (takeNew) {
+            mergedRows.append(newRows.at(newOrder.at(newPos)));
+            mergedKeys.push_back(std::move(newKeys[newOrder.at(newPos)]));
+            ++newPos;
+        } else {
+            mergedRows.append(order.rows.at(oldPos));
+            mergedKeys.push_back(std::move(order.keys[oldPos]));
+            ++oldPos;
+        }
+    }
+    order.rows = mergedRows;
+    order.keys = std::move(mergedKeys);
+    for (int i = 0, iEnd = order.rows.size(); i < iEnd; ++i)
+        order.ranks[order.rows.at(i)] = i;
+    return order.ranks.at(row);
+}
+
 Qt::ItemFlags RatingsModel::flags(const QModelIndex &index) const
 {
     if (!index.isValid() || index.parent().isValid())
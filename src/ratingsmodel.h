@@ -13,9 +13,12 @@
 
 #ifndef RATINGSMODEL_H
 #define RATINGSMODEL_H
+#include "ratingsmerger.h"
+#include "ratingsstore.h"
 #include <QAbstractTableModel>
-#include <QMultiHash>
-class MtgahCard;
+#include <QCollator>
+#include <QVector>
+#include <vector>
 class RatingsModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -31,17 +34,42 @@ public:
         ,
         rmcCount
     };
+    // SortRole is an integer that orders the rows like the column would, with ties broken by row so sorting is stable
+    // SetIdRole is the StringPool id of the set of the card
+    enum RatingsModelRoles { DirtyRole = Qt::UserRole, SortRole, SetIdRole };
     explicit RatingsModel(QObject *parent = nullptr);
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
-    void setRatingsTemplate(QMultiHash<QString, MtgahCard> *tmplt);
+    void setRatingsTemplate(const RatingsStore &tmplt);
+    const RatingsStore &ratingsTemplate() const;
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
+    void applyUpdates(const QVector<RatingUpdate> &updates);
+public slots:
+    void markUploaded(const MtgahCard &card);
 
 private:
-    QMultiHash<QString, MtgahCard> *m_ratingsTemplate;
+    // rows of a column ranked in collation order. The first rank a sort asks for ranks every row that has none,
+    // so ranks do not move while the sort runs. Changed, inserted and removed rows keep the keys of the other rows,
+    // only their own keys are computed again and merged in.
+    struct CollationOrder
+    {
+        // rank of every row, -1 until it is ranked
+        QVector<int> ranks;
+        // ranked rows in collation order and their keys
+        QVector<int> rows;
+        std::vector<QCollatorSortKey> keys;
+    };
+    void invalidateSortKeys(int column = -1);
+    void invalidateSortKeys(int column, int firstRow, int lastRow);
+    void insertSortKeys(int firstRow, int count);
+    void removeSortKeys(int firstRow, int count);
+    int collationRank(int column, int row) const;
+    RatingsStore m_ratingsTemplate;
+    QCollator m_collator;
+    mutable CollationOrder m_collationOrders[rmcCount];
 };
 
 #endif
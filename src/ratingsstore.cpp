@@ -0,0 +1,192 @@
+#include "ratingsstore.h"
+#include "tracer.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <algorithm>
+namespace {
+bool sameSet(const MtgahCard &a, const MtgahCard &b)
+{
+    if (a.setId >= 0 && b.setId >= 0)
+        return a.setId == b.setId;
+    return a.set == b.set;
+}
+}
+
+RatingsStore::RatingsStore() { }
+
+RatingsStore::RatingsStore(const QVector<MtgahCard> &cards)
+    : m_cards(cards)
+{
+    std::sort(m_cards.begin(), m_cards.end(), &RatingsStore::lessThan);
+    reindex();
+}
+
+RatingsStore RatingsStore::fromMtgahTemplate(const QByteArray &json)
+{
+    QJsonDocument ratingsDocument;
+    {
+        TraceSpan parseSpan("JSON parse", "cpu");
+        QJsonParseError parseErr;
+        ratingsDocument = QJsonDocument::fromJson(json, &parseErr);
+        if (parseErr.error != QJsonParseError::NoError || !ratingsDocument.isArray())
+            return RatingsStore();
+    }
+    TraceSpan ingestSpan("ingest", "cpu");
+    QVector<MtgahCard> rtgsTemplate;
+    QSet<int> knownIds;
+    const QJsonArray ratingsArray = ratingsDocument.array();
+    rtgsTemplate.reserve(ratingsArray.size());
+    knownIds.reserve(ratingsArray.size());
+    for (auto i = ratingsArray.cbegin(), iEnd = ratingsArray.cend(); i != iEnd; ++i) {
+        if (!i->isObject())
+            continue;
+        const QJsonObject ratingObject = i->toObject();
+        const QJsonObject cardObject = ratingObject[QLatin1String("card")].toObject();
+        if (cardObject.isEmpty())
+            continue;
+        const int idArenaVal = cardObject[QLatin1String("idArena")].toInt();
+        if (knownIds.contains(idArenaVal))
+            continue;
+        const QString setStr = cardObject[QLatin1String("set")].toString().trimmed().toUpper();
+        if (setStr.isEmpty())
+            continue;
+        const QString nameStr = cardObject[QLatin1String("name")].toString();
+        if (nameStr.isEmpty())
+            continue;
+        MtgahCard card;
+        card.setName(nameStr);
+        card.id_arena = idArenaVal;
+        card.setSet(setStr);
+        const QJsonValue noteValue = ratingObject[QLatin1String("note")];
+        if (!noteValue.isNull())
+            card.note = noteValue.toString();
+        const QJsonValue ratingValue = ratingObject[QLatin1String("rating")];
+        if (!ratingValue.isNull())
+            card.rating = ratingValue.toInt();
+        card.markClean();
+        knownIds.insert(idArenaVal);
+        rtgsTemplate.append(card);
+    }
+    ingestSpan.setCards(rtgsTemplate.size());
+    return RatingsStore(rtgsTemplate);
+}
+
+int RatingsStore::size() const
+{
+    return m_cards.size();
+}
+
+bool RatingsStore::isEmpty() const
+{
+    return m_cards.isEmpty();
+}
+
+void RatingsStore::clear()
+{
+    m_cards.clear();
+    m_setRanges.clear();
+    m_arenaIndex.clear();
+    m_sets.clear();
+}
+
+const MtgahCard &RatingsStore::at(int row) const
+{
+    Q_ASSERT(row >= 0 && row < m_cards.size());
+    return m_cards.at(row);
+}
+
+MtgahCard &RatingsStore::card(int row)
+{
+    Q_ASSERT(row >= 0 && row < m_cards.size());
+    return m_cards[row];
+}
+
+int RatingsStore::rowForArenaId(int idArena) const
+{
+    return m_arenaIndex.value(idArena, -1);
+}
+
+std::pair<int, int> RatingsStore::setRange(const QString &set) const
+{
+    return m_setRanges.value(set, std::make_pair(0, 0));
+}
+
+const QStringList &RatingsStore::sets() const
+{
+    return m_sets;
+}
+
+QVector<MtgahCard> RatingsStore::cards(const QStringList &sets) const
+{
+    QVector<MtgahCard> result;
+    for (const QString &set : sets) {
+        const std::pair<int, int> range = setRange(set);
+        for (int i = range.first; i < range.second; ++i)
+            result.append(m_cards.at(i));
+    }
+    return result;
+}
+
+QVector<MtgahCard> RatingsStore::dirtyCards(const QStringList &sets) const
+{
+    QVector<MtgahCard> result;
+    for (const QString &set : sets) {
+        const std::pair<int, int> range = setRange(set);
+        for (int i = range.first; i < range.second; ++i) {
+            if (m_cards.at(i).isDirty())
+                result.append(m_cards.at(i));
+        }
+    }
+    return result;
+}
+
+int RatingsStore::count(const QStringList &sets) const
+{
+    int result = 0;
+    for (const QString &set : sets) {
+        const std::pair<int, int> range = setRange(set);
+        result += range.second - range.first;
+    }
+    return result;
+}
+
+// insertCards() and removeCards() leave the set ranges and the arena id index stale until reindex() is called
+void RatingsStore::insertCards(int row, const QVector<MtgahCard> &cards)
+{
+    Q_ASSERT(row >= 0 && row <= m_cards.size());
+    m_cards.insert(row, cards.size(), MtgahCard());
+    std::copy(cards.cbegin(), cards.cend(), m_cards.begin() + row);
+}
+
+void RatingsStore::removeCards(int row, int count)
+{
+    Q_ASSERT(row >= 0 && count >= 0 && row + count <= m_cards.size());
+    m_cards.remove(row, count);
+}
+
+bool RatingsStore::lessThan(const MtgahCard &a, const MtgahCard &b)
+{
+    if (sameSet(a, b))
+        return a.id_arena < b.id_arena;
+    return a.set < b.set;
+}
+
+void RatingsStore::reindex()
+{
+    m_setRanges.clear();
+    m_arenaIndex.clear();
+    m_sets.clear();
+    m_arenaIndex.reserve(m_cards.size());
+    for (int i = 0, iEnd = m_cards.size(); i < iEnd;) {
+        const MtgahCard &first = m_cards.at(i);
+        const QString &currSet = first.set;
+        int j = i;
+        for (; j < iEnd && sameSet(m_cards.at(j), first); ++j)
+            m_arenaIndex.insert(m_cards.at(j).id_arena, j);
+        m_setRanges.insert(currSet, std::make_pair(i, j));
+        m_sets.append(currSet);
+        i = j;
+    }
+}
@@ -0,0 +1,57 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+#ifndef RATINGSSTORE_H
+#define RATINGSSTORE_H
+#include "mtgahcard.h"
+#include <QByteArray>
+#include <QHash>
+#include <QMetaType>
+#include <QStringList>
+#include <QVector>
+#include <utility>
+// Cards are kept sorted by set and then by arena id so every set occupies a contiguous range of rows
+class RatingsStore
+{
+public:
+    RatingsStore();
+    explicit RatingsStore(const QVector<MtgahCard> &cards);
+    // parses the customDraftRatingsForDisplay reply of MTGAHelper, empty on failure
+    static RatingsStore fromMtgahTemplate(const QByteArray &json);
+    RatingsStore(const RatingsStore &other) = default;
+    RatingsStore &operator=(const RatingsStore &other) = default;
+    int size() const;
+    bool isEmpty() const;
+    void clear();
+    const MtgahCard &at(int row) const;
+    MtgahCard &card(int row);
+    int rowForArenaId(int idArena) const;
+    // half-open [first, second) range, empty if the set is unknown
+    std::pair<int, int> setRange(const QString &set) const;
+    const QStringList &sets() const;
+    QVector<MtgahCard> cards(const QStringList &sets) const;
+    QVector<MtgahCard> dirtyCards(const QStringList &sets) const;
+    int count(const QStringList &sets) const;
+    void insertCards(int row, const QVector<MtgahCard> &cards);
+    void removeCards(int row, int count);
+    void reindex();
+    static bool lessThan(const MtgahCard &a, const MtgahCard &b);
+
+private:
+    QVector<MtgahCard> m_cards;
+    QHash<QString, std::pair<int, int>> m_setRanges;
+    QHash<int, int> m_arenaIndex;
+    QStringList m_sets;
+};
+Q_DECLARE_METATYPE(RatingsStore)
+#endif
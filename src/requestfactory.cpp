@@ -0,0 +1,58 @@
+#include "requestfactory.h"
+#include <QNetworkAccessManager>
+#include <QSet>
+#ifndef QT_NO_SSL
+#    include <QSslConfiguration>
+#endif
+
+RequestFactory::RequestFactory(const Endpoints &endpoints)
+    : m_endpoints(endpoints)
+{ }
+
+const Endpoints &RequestFactory::endpoints() const
+{
+    return m_endpoints;
+}
+
+void RequestFactory::setEndpoints(const Endpoints &endpoints)
+{
+    m_endpoints = endpoints;
+}
+
+QNetworkRequest RequestFactory::request(Endpoints::Service service, const QString &pathAndQuery) const
+{
+    QNetworkRequest result(m_endpoints.url(service, pathAndQuery));
+    result.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    return result;
+}
+
+QNetworkRequest RequestFactory::jsonRequest(Endpoints::Service service, const QString &pathAndQuery) const
+{
+    QNetworkRequest result = request(service, pathAndQuery);
+    result.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+    return result;
+}
+
+void RequestFactory::prewarm(QNetworkAccessManager *nam) const
+{
+    QSet<QString> warmed;
+    for (int i = 0; i < Endpoints::ServiceCount; ++i) {
+        const QUrl baseUrl = m_endpoints.baseUrl(static_cast<Endpoints::Service>(i));
+        const bool encrypted = baseUrl.scheme() == QLatin1String("https");
+        const quint16 port = baseUrl.port(encrypted ? 443 : 80);
+        const QString hostKey = baseUrl.host() + QLatin1Char(':') + QString::number(port);
+        if (warmed.contains(hostKey))
+            continue;
+        warmed.insert(hostKey);
+#ifndef QT_NO_SSL
+        if (encrypted) {
+            // the connection is only reused if it negotiated the same protocols a request would
+            QSslConfiguration sslConfiguration = QSslConfiguration::defaultConfiguration();
+            sslConfiguration.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2, QSslConfiguration::NextProtocolHttp1_1});
+            nam->connectToHostEncrypted(baseUrl.host(), port, sslConfiguration);
+            continue;
+        }
+#endif
+        nam->connectToHost(baseUrl.host(), port);
+    }
+}
@@ -0,0 +1,39 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef REQUESTFACTORY_H
+#define REQUESTFACTORY_H
+#include "endpoints.h"
+#include <QNetworkRequest>
+class QNetworkAccessManager;
+// Builds every request sent to the remote services with the same transport settings:
+// HTTP/2 when the server negotiates it, so concurrent requests to a host share one connection.
+// HTTP/1.1 connections are kept alive by QNetworkAccessManager; Accept-Encoding is also left to it
+// because setting it by hand disables its streaming decompression.
+class RequestFactory
+{
+public:
+    explicit RequestFactory(const Endpoints &endpoints = Endpoints());
+    const Endpoints &endpoints() const;
+    void setEndpoints(const Endpoints &endpoints);
+    QNetworkRequest request(Endpoints::Service service, const QString &pathAndQuery) const;
+    QNetworkRequest jsonRequest(Endpoints::Service service, const QString &pathAndQuery) const;
+    // opens (and for https completes the TLS handshake of) a connection to every service ahead of the first request
+    void prewarm(QNetworkAccessManager *nam) const;
+
+private:
+    Endpoints m_endpoints;
+};
+
+#endif
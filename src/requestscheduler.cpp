@@ -0,0 +1,181 @@
+#include "requestscheduler.h"
+#include "tracer.h"
+#include <QDateTime>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+RequestScheduler::HostPolicy::HostPolicy()
+    : maxInFlight(4)
+    , requestsPerSecond(10.0)
+    , burst(4.0)
+    , maxRetries(4)
+    , baseRetryDelay(500)
+    , maxRetryDelay(30000)
+{ }
+
+RequestScheduler::HostState::HostState()
+    : inFlight(0)
+    , tokens(-1.0)
+    , lastRefill(0)
+    , blockedUntil(0)
+{ }
+
+RequestScheduler::RequestScheduler(QNetworkAccessManager *nam, QObject *parent)
+    : QObject(parent)
+    , m_nam(nam)
+    , m_wakeTimer(new QTimer(this))
+{
+    Q_ASSERT(m_nam);
+    m_wakeTimer->setSingleShot(true);
+    connect(m_wakeTimer, &QTimer::timeout, this, &RequestScheduler::dispatch);
+    m_clock.start();
+}
+
+void RequestScheduler::setDefaultPolicy(const HostPolicy &policy)
+{
+    m_defaultPolicy = policy;
+    dispatch();
+}
+
+void RequestScheduler::setHostPolicy(const QString &host, const HostPolicy &policy)
+{
+    m_policies.insert(host, policy);
+    dispatch();
+}
+
+RequestScheduler::HostPolicy RequestScheduler::hostPolicy(const QString &host) const
+{
+    return m_policies.value(host, m_defaultPolicy);
+}
+
+void RequestScheduler::get(const QNetworkRequest &request, const ReplyHandler &onStarted, const ReplyHandler &onFinished)
+{
+    enqueue(PendingRequest{request, QByteArrayLiteral("GET"), QByteArray(), onStarted, onFinished, 0, -1});
+}
+
+void RequestScheduler::put(const QNetworkRequest &request, const QByteArray &body, const ReplyHandler &onStarted, const ReplyHandler &onFinished)
+{
+    enqueue(PendingRequest{request, QByteArrayLiteral("PUT"), body, onStarted, onFinished, 0, -1});
+}
+
+int RequestScheduler::pendingCount() const
+{
+    int result = 0;
+    for (auto i = m_hosts.cbegin(), iEnd = m_hosts.cend(); i != iEnd; ++i)
+        result += i->queue.size() + i->inFlight;
+    return result;
+}
+
+void RequestScheduler::enqueue(PendingRequest request)
+{
+    if (Tracer::isEnabled())
+        request.queuedAt = Tracer::now();
+    m_hosts[request.request.url().host()].queue.append(request);
+    dispatch();
+}
+
+void RequestScheduler::dispatch()
+{
+    const qint64 now = m_clock.elapsed();
+    qint64 nextWake = -1;
+    for (auto i = m_hosts.begin(), iEnd = m_hosts.end(); i != iEnd; ++i) {
+        HostState &state = i.value();
+        const HostPolicy policy = hostPolicy(i.key());
+        if (policy.requestsPerSecond > 0.0) {
+            if (state.tokens < 0.0)
+                state.tokens = policy.burst;
+            else
+                state.tokens = std::min(policy.burst, state.tokens + (now - state.lastRefill) * policy.requestsPerSecond / 1000.0);
+            state.lastRefill = now;
+        }
+        while (!state.queue.isEmpty() && state.inFlight < policy.maxInFlight) {
+            qint64 readyAt = now;
+            if (state.blockedUntil > now)
+                readyAt = state.blockedUntil;
+            else if (policy.requestsPerSecond > 0.0 && state.tokens < 1.0)
+                readyAt = now + static_cast<qint64>(std::ceil((1.0 - state.tokens) * 1000.0 / policy.requestsPerSecond));
+            if (readyAt > now) {
+                if (nextWake < 0 || readyAt < nextWake)
+                    nextWake = readyAt;
+                break;
+            }
+            if (policy.requestsPerSecond > 0.0)
+                state.tokens -= 1.0;
+            start(i.key(), state, state.queue.takeFirst());
+        }
+    }
+    if (nextWake < 0)
+        m_wakeTimer->stop();
+    else
+        m_wakeTimer->start(static_cast<int>(nextWake - now));
+}
+
+void RequestScheduler::start(const QString &host, HostState &state, const PendingRequest &request)
+{
+    ++state.inFlight;
+    QNetworkReply *reply;
+    if (request.verb == "GET")
+        reply = m_nam->get(request.request);
+    else
+        reply = m_nam->sendCustomRequest(request.request, request.verb, request.body);
+    Tracer::traceReply(reply, request.queuedAt);
+    emit replyStarted(reply);
+    if (request.onStarted)
+        request.onStarted(reply);
+    connect(reply, &QNetworkReply::finished, this, std::bind(&RequestScheduler::onReplyFinished, this, host, request, reply));
+}
+
+void RequestScheduler::onReplyFinished(const QString &host, PendingRequest request, QNetworkReply *reply)
+{
+    reply->deleteLater();
+    HostState &state = m_hosts[host];
+    --state.inFlight;
+    const HostPolicy policy = hostPolicy(host);
+    const qint64 delay = request.attempt < policy.maxRetries ? retryDelay(policy, request, reply) : -1;
+    if (delay >= 0) {
+        state.blockedUntil = std::max(state.blockedUntil, m_clock.elapsed() + delay);
+        ++request.attempt;
+        if (Tracer::isEnabled())
+            request.queuedAt = Tracer::now();
+        state.queue.prepend(request);
+    } else if (request.onFinished) {
+        request.onFinished(reply);
+    }
+    dispatch();
+}
+
+// Returns how long the host should be left alone before retrying or -1 if the reply is final
+qint64 RequestScheduler::retryDelay(const HostPolicy &policy, const PendingRequest &request, QNetworkReply *reply) const
+{
+    const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (statusCode == 429 || statusCode == 503) {
+        const QByteArray retryAfter = reply->rawHeader(QByteArrayLiteral("Retry-After")).trimmed();
+        if (!retryAfter.isEmpty()) {
+            bool isSeconds = false;
+            const qint64 seconds = retryAfter.toLongLong(&isSeconds);
+            if (isSeconds)
+                return std::max<qint64>(0, seconds * 1000);
+            const QDateTime retryDate = QDateTime::fromString(QString::fromLatin1(retryAfter), Qt::RFC2822Date);
+            if (retryDate.isValid())
+                return std::max<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(retryDate));
+        }
+    } else if (statusCode != 502 && statusCode != 504) {
+        switch (reply->error()) {
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::ProxyTimeoutError:
+        case QNetworkReply::UnknownNetworkError:
+            break;
+        default:
+            return -1;
+        }
+    }
+    const double backOff = std::min<double>(policy.maxRetryDelay, policy.baseRetryDelay * std::pow(2.0, request.attempt));
+    return static_cast<qint64>(backOff * (0.5 + QRandomGenerator::global()->bounded(0.5)));
+}
@@ -0,0 +1,87 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QNetworkRequest>
+#include <QObject>
+#include <functional>
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+class RequestScheduler : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(RequestScheduler)
+public:
+    struct HostPolicy
+    {
+        HostPolicy();
+        int maxInFlight;
+        double requestsPerSecond;
+        double burst;
+        int maxRetries;
+        int baseRetryDelay;
+        int maxRetryDelay;
+    };
+    typedef std::function<void(QNetworkReply *)> ReplyHandler;
+    explicit RequestScheduler(QNetworkAccessManager *nam, QObject *parent = nullptr);
+    void setDefaultPolicy(const HostPolicy &policy);
+    void setHostPolicy(const QString &host, const HostPolicy &policy);
+    HostPolicy hostPolicy(const QString &host) const;
+    void get(const QNetworkRequest &request, const ReplyHandler &onStarted, const ReplyHandler &onFinished);
+    void put(const QNetworkRequest &request, const QByteArray &body, const ReplyHandler &onStarted, const ReplyHandler &onFinished);
+    int pendingCount() const;
+signals:
+    // every attempt, retries included
+    void replyStarted(QNetworkReply *reply);
+
+private slots:
+    void dispatch();
+
+private:
+    struct PendingRequest
+    {
+        QNetworkRequest request;
+        QByteArray verb;
+        QByteArray body;
+        ReplyHandler onStarted;
+        ReplyHandler onFinished;
+        int attempt;
+        qint64 queuedAt;
+    };
+    struct HostState
+    {
+        HostState();
+        QList<PendingRequest> queue;
+        int inFlight;
+        double tokens;
+        qint64 lastRefill;
+        qint64 blockedUntil;
+    };
+    void enqueue(PendingRequest request);
+    void start(const QString &host, HostState &state, const PendingRequest &request);
+    void onReplyFinished(const QString &host, PendingRequest request, QNetworkReply *reply);
+    qint64 retryDelay(const HostPolicy &policy, const PendingRequest &request, QNetworkReply *reply) const;
+    QNetworkAccessManager *m_nam;
+    QTimer *m_wakeTimer;
+    QElapsedTimer m_clock;
+    HostPolicy m_defaultPolicy;
+    QHash<QString, HostPolicy> m_policies;
+    QHash<QString, HostState> m_hosts;
+};
+
+#endif
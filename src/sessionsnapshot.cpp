@@ -0,0 +1,187 @@
+#include "sessionsnapshot.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QVector>
+namespace {
+const quint32 snapshotMagic = 0x17515A90;
+const quint16 snapshotVersion = 1;
+}
+
+SessionSnapshot::SessionSnapshot(const QString &fileName)
+    : m_fileName(fileName)
+{
+    if (m_fileName.isEmpty())
+        m_fileName = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QLatin1String("/snapshot.bin");
+}
+
+bool SessionSnapshot::load()
+{
+    m_sets.clear();
+    m_setNames.clear();
+    clearSession();
+    QFile snapshotFile(m_fileName);
+    if (!snapshotFile.open(QIODevice::ReadOnly))
+        return false;
+    const QByteArray payload = qUncompress(snapshotFile.readAll());
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if (magic != snapshotMagic || version != snapshotVersion)
+        return false;
+    QList<QByteArray> rawCookies;
+    qint32 cardCount = 0;
+    stream >> m_sets >> m_setNames >> m_account >> rawCookies >> m_templateHash >> cardCount;
+    QVector<MtgahCard> cards;
+    if (stream.status() == QDataStream::Ok && cardCount > 0)
+        cards.reserve(cardCount);
+    for (qint32 i = 0; i < cardCount && stream.status() == QDataStream::Ok; ++i) {
+        MtgahCard card;
+        QString name;
+        QString set;
+        qint8 rating = -1;
+        stream >> card.id_arena >> name >> set >> rating >> card.note;
+        card.setName(name);
+        card.setSet(set);
+        card.rating = rating;
+        card.markClean();
+        cards.append(card);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        m_sets.clear();
+        m_setNames.clear();
+        clearSession();
+        return false;
+    }
+    for (const QByteArray &rawCookie : rawCookies)
+        m_cookies.append(QNetworkCookie::parseCookies(rawCookie));
+    m_ratingsTemplate = RatingsStore(cards);
+    return true;
+}
+
+bool SessionSnapshot::save() const
+{
+    QByteArray payload;
+    {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_6_0);
+        QList<QByteArray> rawCookies;
+        rawCookies.reserve(m_cookies.size());
+        for (const QNetworkCookie &cookie : m_cookies)
+            rawCookies.append(cookie.toRawForm(QNetworkCookie::Full));
+        stream << snapshotMagic << snapshotVersion << m_sets << m_setNames << m_account << rawCookies << m_templateHash
+               << qint32(m_ratingsTemplate.size());
+        // the server side of the cards, what the template looked like when it was downloaded
+        for (int i = 0, iEnd = m_ratingsTemplate.size(); i < iEnd; ++i) {
+            const MtgahCard &card = m_ratingsTemplate.at(i);
+            stream << card.id_arena << card.name << card.set << qint8(card.serverRating) << card.serverNote;
+        }
+    }
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+    const QByteArray compressed = qCompress(payload);
+    QSaveFile snapshotFile(m_fileName);
+    if (!snapshotFile.open(QIODevice::WriteOnly) || snapshotFile.write(compressed) != compressed.size())
+        return false;
+    // the auth cookies log the account in, nobody but the owner may read them
+    snapshotFile.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    return snapshotFile.commit();
+}
+
+void SessionSnapshot::clear()
+{
+    m_sets.clear();
+    m_setNames.clear();
+    clearSession();
+    QFile::remove(m_fileName);
+}
+
+const QStringList &SessionSnapshot::sets() const
+{
+    return m_sets;
+}
+
+void SessionSnapshot::setSets(const QStringList &sets)
+{
+    m_sets = sets;
+}
+
+const QHash<QString, QString> &SessionSnapshot::setNames() const
+{
+    return m_setNames;
+}
+
+void SessionSnapshot::setSetNames(const QHash<QString, QString> &setNames)
+{
+    m_setNames = setNames;
+}
+
+const QString &SessionSnapshot::account() const
+{
+    return m_account;
+}
+
+const QList<QNetworkCookie> &SessionSnapshot::cookies() const
+{
+    return m_cookies;
+}
+
+void SessionSnapshot::setSession(const QString &account, const QList<QNetworkCookie> &cookies)
+{
+    if (account.compare(m_account, Qt::CaseInsensitive) != 0) {
+        m_ratingsTemplate.clear();
+        m_templateHash.clear();
+    }
+    m_account = account;
+    m_cookies = cookies;
+}
+
+void SessionSnapshot::clearSession()
+{
+    m_account.clear();
+    m_cookies.clear();
+    m_ratingsTemplate.clear();
+    m_templateHash.clear();
+}
+
+const RatingsStore &SessionSnapshot::ratingsTemplate() const
+{
+    return m_ratingsTemplate;
+}
+
+const QByteArray &SessionSnapshot::templateHash() const
+{
+    return m_templateHash;
+}
+
+void SessionSnapshot::setRatingsTemplate(const RatingsStore &ratingsTemplate, const QByteArray &hash)
+{
+    m_ratingsTemplate = ratingsTemplate;
+    m_templateHash = hash;
+}
+
+QList<QNetworkCookie> SessionCookieJar::cookies() const
+{
+    return allCookies();
+}
+
+void SessionCookieJar::setCookies(const QList<QNetworkCookie> &cookies)
+{
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    QList<QNetworkCookie> validCookies;
+    for (const QNetworkCookie &cookie : cookies) {
+        if (cookie.isSessionCookie() || cookie.expirationDate() > now)
+            validCookies.append(cookie);
+    }
+    setAllCookies(validCookies);
+}
+
+void SessionCookieJar::clear()
+{
+    setAllCookies(QList<QNetworkCookie>());
+}
@@ -0,0 +1,73 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef SESSIONSNAPSHOT_H
+#define SESSIONSNAPSHOT_H
+#include "ratingsstore.h"
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QNetworkCookie>
+#include <QNetworkCookieJar>
+#include <QString>
+#include <QStringList>
+// What the application downloaded last time it ran: the sets of MTGAHelper, their Scryfall names,
+// the session of the logged in account and its ratings template.
+// It is stored as one compressed file so startup can show it before anything is revalidated.
+// The template keeps only the server side of the cards, local edits are never part of it.
+class SessionSnapshot
+{
+    Q_DISABLE_COPY_MOVE(SessionSnapshot)
+public:
+    explicit SessionSnapshot(const QString &fileName = QString());
+    // false if there is no snapshot or it is unreadable, the snapshot is then empty
+    bool load();
+    bool save() const;
+    void clear();
+    const QStringList &sets() const;
+    void setSets(const QStringList &sets);
+    const QHash<QString, QString> &setNames() const;
+    void setSetNames(const QHash<QString, QString> &setNames);
+    const QString &account() const;
+    const QList<QNetworkCookie> &cookies() const;
+    // replacing the account drops the template of the previous one
+    void setSession(const QString &account, const QList<QNetworkCookie> &cookies);
+    void clearSession();
+    const RatingsStore &ratingsTemplate() const;
+    // hash of the reply the template was parsed from
+    const QByteArray &templateHash() const;
+    void setRatingsTemplate(const RatingsStore &ratingsTemplate, const QByteArray &hash);
+
+private:
+    QString m_fileName;
+    QStringList m_sets;
+    QHash<QString, QString> m_setNames;
+    QString m_account;
+    QList<QNetworkCookie> m_cookies;
+    RatingsStore m_ratingsTemplate;
+    QByteArray m_templateHash;
+};
+
+// Cookie jar whose cookies can be read back and restored from a snapshot
+class SessionCookieJar : public QNetworkCookieJar
+{
+    Q_DISABLE_COPY_MOVE(SessionCookieJar)
+public:
+    using QNetworkCookieJar::QNetworkCookieJar;
+    QList<QNetworkCookie> cookies() const;
+    // expired cookies are dropped
+    void setCookies(const QList<QNetworkCookie> &cookies);
+    void clear();
+};
+#endif
@@ -0,0 +1,274 @@
+#include "setfilterproxymodel.h"
+#include "setsmodel.h"
+#include <algorithm>
+#include <numeric>
+
+SetFilterProxyModel::SetFilterProxyModel(SetsModel *sets, int setColumn, int setIdRole, QObject *parent)
+    : QAbstractProxyModel(parent)
+    , m_sets(sets)
+    , m_setColumn(setColumn)
+    , m_setIdRole(setIdRole)
+{
+    Q_ASSERT(m_sets);
+    connect(m_sets, &SetsModel::setCheckChanged, this, &SetFilterProxyModel::onSetCheckChanged);
+    connect(m_sets, &QAbstractItemModel::modelReset, this, [this]() {
+        beginResetModel();
+        rebuild();
+        endResetModel();
+    });
+}
+
+void SetFilterProxyModel::setSourceModel(QAbstractItemModel *newSourceModel)
+{
+    beginResetModel();
+    const QVector<QMetaObject::Connection> &sourceConnections = m_sourceConnections;
+    for (const QMetaObject::Connection &connection : sourceConnections)
+        disconnect(connection);
+    m_sourceConnections.clear();
+    QAbstractProxyModel::setSourceModel(newSourceModel);
+    if (newSourceModel) {
+        // the source is flat, anything moving rows or changing the layout starts over
+        const auto beginReset = [this]() { beginResetModel(); };
+        const auto endReset = [this]() {
+            rebuild();
+            endResetModel();
+        };
+        m_sourceConnections = {
+                connect(newSourceModel, &QAbstractItemModel::dataChanged, this, &SetFilterProxyModel::onSourceDataChanged),
+                connect(newSourceModel, &QAbstractItemModel::headerDataChanged, this, &QAbstractItemModel::headerDataChanged),
+                connect(newSourceModel, &QAbstractItemModel::rowsInserted, this, &SetFilterProxyModel::onSourceRowsInserted),
+                connect(newSourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &SetFilterProxyModel::onSourceRowsAboutToBeRemoved),
+                connect(newSourceModel, &QAbstractItemModel::rowsRemoved, this, &SetFilterProxyModel::onSourceRowsRemoved),
+                connect(newSourceModel, &QAbstractItemModel::rowsAboutToBeMoved, this, beginReset),
+                connect(newSourceModel, &QAbstractItemModel::rowsMoved, this, endReset),
+                connect(newSourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, beginReset),
+                connect(newSourceModel, &QAbstractItemModel::layoutChanged, this, endReset),
+                connect(newSourceModel, &QAbstractItemModel::modelAboutToBeReset, this, beginReset),
+                connect(newSourceModel, &QAbstractItemModel::modelReset, this, endReset),
+        };
+    }
+    rebuild();
+    endResetModel();
+}
+
+void SetFilterProxyModel::rebuild()
+{
+    m_proxyToSource.clear();
+    m_setRuns.clear();
+    const QAbstractItemModel *source = sourceModel();
+    if (!source)
+        return;
+    int runSet = -1;
+    for (int i = 0, iEnd = source->rowCount(); i < iEnd; ++i) {
+        const int setId = sourceSetId(i);
+        RowRuns &runs = m_setRuns[setId];
+        if (i > 0 && setId == runSet)
+            ++runs.last().second;
+        else
+            runs.append(std::make_pair(i, i + 1));
+        runSet = setId;
+        if (m_sets->isChecked(setId))
+            m_proxyToSource.append(i);
+    }
+}
+
+int SetFilterProxyModel::sourceSetId(int sourceRow) const
+{
+    const QModelIndex setIndex = sourceModel()->index(sourceRow, m_setColumn);
+    bool validId = false;
+    const int setId = setIndex.data(m_setIdRole).toInt(&validId);
+    if (!validId || setId < 0)
+        return m_sets->setId(setIndex.data().toString());
+    return setId;
+}
+
+// adds the source rows [first, last) to the runs of the set, joining the runs they touch
+void SetFilterProxyModel::addRun(int setId, int first, int last)
+{
+    RowRuns &runs = m_setRuns[setId];
+    const auto runIter = std::lower_bound(runs.begin(), runs.end(), std::make_pair(first, last));
+    int runIdx = runIter - runs.begin();
+    if (runIdx > 0 && runs.at(runIdx - 1).second == first) {
+        --runIdx;
+        runs[runIdx].second = last;
+    } else {
+        runs.insert(runIdx, std::make_pair(first, last));
+    }
+    if (runIdx + 1 < runs.size() && runs.at(runIdx + 1).first == last) {
+        runs[runIdx].second = runs.at(runIdx + 1).second;
+        runs.remove(runIdx + 1);
+    }
+}
+
+void SetFilterProxyModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+    const int count = last - first + 1;
+    for (auto setIter = m_setRuns.begin(), setEnd = m_setRuns.end(); setIter != setEnd; ++setIter) {
+        RowRuns &runs = setIter.value();
+        for (int i = runs.size() - 1; i >= 0; --i) {
+            const std::pair<int, int> run = runs.at(i);
+            if (run.first >= first) {
+                runs[i] = std::make_pair(run.first + count, run.second + count);
+            } else if (run.second > first) {
+                // rows inserted inside the run split it
+                runs[i].second = first;
+                runs.insert(i + 1, std::make_pair(first + count, run.second + count));
+            }
+        }
+    }
+    const int proxyFirst = proxyRowFor(first);
+    for (int i = proxyFirst, iEnd = m_proxyToSource.size(); i < iEnd; ++i)
+        m_proxyToSource[i] += count;
+    QVector<int> insertedRows;
+    for (int i = first; i <= last;) {
+        const int setId = sourceSetId(i);
+        int runEnd = i + 1;
+        while (runEnd <= last && sourceSetId(runEnd) == setId)
+            ++runEnd;
+        addRun(setId, i, runEnd);
+        if (m_sets->isChecked(setId)) {
+            for (; i < runEnd; ++i)
+                insertedRows.append(i);
+        }
+        i = runEnd;
+    }
+    if (insertedRows.isEmpty())
+        return;
+    beginInsertRows(QModelIndex(), proxyFirst, proxyFirst + insertedRows.size() - 1);
+    m_proxyToSource.insert(proxyFirst, insertedRows.size(), 0);
+    std::copy(insertedRows.cbegin(), insertedRows.cend(), m_proxyToSource.begin() + proxyFirst);
+    endInsertRows();
+}
+
+void SetFilterProxyModel::onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+    const int proxyFirst = proxyRowFor(first);
+    const int proxyEnd = proxyRowFor(last + 1);
+    if (proxyFirst < proxyEnd)
+        beginRemoveRows(QModelIndex(), proxyFirst, proxyEnd - 1);
+}
+
+// the proxy rows are still the ones before the removal, onSourceRowsAboutToBeRemoved() began removing the same range
+void SetFilterProxyModel::onSourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+    const int count = last - first + 1;
+    // where a boundary of a run ends up once the rows are gone
+    const auto shifted = [first, last, count](int row) { return row <= first ? row : (row > last ? row - count : first); };
+    for (auto setIter = m_setRuns.begin(); setIter != m_setRuns.end();) {
+        RowRuns &runs = setIter.value();
+        RowRuns remaining;
+        remaining.reserve(runs.size());
+        for (const std::pair<int, int> &run : runs) {
+            const std::pair<int, int> newRun(shifted(run.first), shifted(run.second));
+            if (newRun.first == newRun.second)
+                continue;
+            // two runs of the set only split by the removed rows join again
+            if (!remaining.isEmpty() && remaining.last().second == newRun.first)
+                remaining.last().second = newRun.second;
+            else
+                remaining.append(newRun);
+        }
+        if (remaining.isEmpty()) {
+            setIter = m_setRuns.erase(setIter);
+            continue;
+        }
+        runs = remaining;
+        ++setIter;
+    }
+    const int proxyFirst = proxyRowFor(first);
+    const int proxyEnd = proxyRowFor(last + 1);
+    m_proxyToSource.remove(proxyFirst, proxyEnd - proxyFirst);
+    for (int i = proxyFirst, iEnd = m_proxyToSource.size(); i < iEnd; ++i)
+        m_proxyToSource[i] -= count;
+    if (proxyFirst < proxyEnd)
+        endRemoveRows();
+}
+
+void SetFilterProxyModel::onSetCheckChanged(int setId, bool checked)
+{
+    const RowRuns runs = m_setRuns.value(setId);
+    for (const std::pair<int, int> &run : runs) {
+        const int proxyFirst = proxyRowFor(run.first);
+        const int runSize = run.second - run.first;
+        if (checked) {
+            beginInsertRows(QModelIndex(), proxyFirst, proxyFirst + runSize - 1);
+            m_proxyToSource.insert(proxyFirst, runSize, 0);
+            std::iota(m_proxyToSource.begin() + proxyFirst, m_proxyToSource.begin() + proxyFirst + runSize, run.first);
+            endInsertRows();
+        } else {
+            beginRemoveRows(QModelIndex(), proxyFirst, proxyFirst + runSize - 1);
+            m_proxyToSource.remove(proxyFirst, runSize);
+            endRemoveRows();
+        }
+    }
+}
+
+void SetFilterProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    const int proxyFirst = proxyRowFor(topLeft.row());
+    const int proxyLast = proxyRowFor(bottomRight.row() + 1) - 1;
+    if (proxyFirst > proxyLast)
+        return;
+    emit dataChanged(index(proxyFirst, topLeft.column()), index(proxyLast, bottomRight.column()), roles);
+}
+
+// first proxy row whose source row is not before sourceRow
+int SetFilterProxyModel::proxyRowFor(int sourceRow) const
+{
+    return std::lower_bound(m_proxyToSource.cbegin(), m_proxyToSource.cend(), sourceRow) - m_proxyToSource.cbegin();
+}
+
+QModelIndex SetFilterProxyModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid() || !sourceModel())
+        return QModelIndex();
+    return sourceModel()->index(m_proxyToSource.at(proxyIndex.row()), proxyIndex.column());
+}
+
+QModelIndex SetFilterProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid())
+        return QModelIndex();
+    const int proxyRow = proxyRowFor(sourceIndex.row());
+    if (proxyRow >= m_proxyToSource.size() || m_proxyToSource.at(proxyRow) != sourceIndex.row())
+        return QModelIndex();
+    return createIndex(proxyRow, sourceIndex.column());
+}
+
+QModelIndex SetFilterProxyModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (parent.isValid() || row < 0 || row >= rowCount() || column < 0 || column >= columnCount())
+        return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex SetFilterProxyModel::parent(const QModelIndex &child) const
+{
+    Q_UNUSED(child)
+    return QModelIndex();
+}
+
+QModelIndex SetFilterProxyModel::sibling(int row, int column, const QModelIndex &idx) const
+{
+    return index(row, column, idx.parent());
+}
+
+int SetFilterProxyModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_proxyToSource.size();
+}
+
+int SetFilterProxyModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !sourceModel())
+        return 0;
+    return sourceModel()->columnCount();
+}
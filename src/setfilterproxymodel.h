@@ -0,0 +1,62 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef SETFILTERPROXYMODEL_H
+#define SETFILTERPROXYMODEL_H
+#include <QAbstractProxyModel>
+#include <QHash>
+#include <QVector>
+#include <utility>
+class SetsModel;
+// Shows the rows of a flat model whose set is checked in a SetsModel.
+// The source rows of every set are kept as runs so checking or unchecking a set
+// inserts or removes just those rows instead of filtering the whole model again.
+// Rows inserted in or removed from the source shift the runs, only rows of checked sets reach the proxy.
+// The set of a row is read as a StringPool id from setIdRole, the code in setColumn is hashed only for rows without one.
+class SetFilterProxyModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(SetFilterProxyModel)
+public:
+    SetFilterProxyModel(SetsModel *sets, int setColumn, int setIdRole, QObject *parent = nullptr);
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    QModelIndex sibling(int row, int column, const QModelIndex &idx) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+private:
+    // half-open [first, second) ranges of source rows
+    typedef QVector<std::pair<int, int>> RowRuns;
+    void rebuild();
+    int sourceSetId(int sourceRow) const;
+    void addRun(int setId, int first, int last);
+    void onSetCheckChanged(int setId, bool checked);
+    void onSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    int proxyRowFor(int sourceRow) const;
+    SetsModel *m_sets;
+    int m_setColumn;
+    int m_setIdRole;
+    QVector<int> m_proxyToSource;
+    QHash<int, RowRuns> m_setRuns;
+    QVector<QMetaObject::Connection> m_sourceConnections;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "setsmodel.h"
+#include "stringpool.h"
+
+SetsModel::SetsModel(QObject *parent)
+    : QAbstractListModel(parent)
+{ }
+
+int SetsModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_rows.size();
+}
+
+QVariant SetsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.parent().isValid() || index.row() >= rowCount())
+        return QVariant();
+    const int id = m_rows.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole: {
+        const QString name = m_names.value(id);
+        return name.isEmpty() ? StringPool::string(id) : name;
+    }
+    case Qt::CheckStateRole:
+        return m_checked.testBit(id) ? Qt::Checked : Qt::Unchecked;
+    case SetCodeRole:
+        return StringPool::string(id);
+    case SetIdRole:
+        return id;
+    default:
+        return QVariant();
+    }
+}
+
+bool SetsModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || index.parent().isValid() || role != Qt::CheckStateRole || index.row() >= rowCount())
+        return false;
+    setChecked(index.row(), value.toInt() == Qt::Checked);
+    return true;
+}
+
+Qt::ItemFlags SetsModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.parent().isValid())
+        return Qt::NoItemFlags;
+    return Qt::ItemIsEnabled | Qt::ItemIsUserCheckable | Qt::ItemNeverHasChildren;
+}
+
+void SetsModel::setSets(const QStringList &sets)
+{
+    beginResetModel();
+    m_rows.clear();
+    m_checked.fill(false);
+    for (const QString &set : sets)
+        m_rows.append(internSet(set));
+    endResetModel();
+}
+
+void SetsModel::setSetNames(const QHash<QString, QString> &setNames)
+{
+    for (auto i = setNames.cbegin(), iEnd = setNames.cend(); i != iEnd; ++i)
+        m_names[internSet(i.key())] = i.value();
+    if (!m_rows.isEmpty())
+        emit dataChanged(index(0, 0), index(m_rows.size() - 1, 0), {Qt::DisplayRole});
+}
+
+void SetsModel::setChecked(int row, bool checked)
+{
+    const int id = m_rows.at(row);
+    if (m_checked.testBit(id) == checked)
+        return;
+    m_checked.setBit(id, checked);
+    const QModelIndex changedIndex = index(row, 0);
+    emit dataChanged(changedIndex, changedIndex, {Qt::CheckStateRole});
+    emit setCheckChanged(id, checked);
+}
+
+void SetsModel::setAllChecked(bool checked)
+{
+    for (int i = 0, iEnd = m_rows.size(); i < iEnd; ++i)
+        setChecked(i, checked);
+}
+
+int SetsModel::setId(const QString &set) const
+{
+    return StringPool::find(set);
+}
+
+bool SetsModel::isChecked(int setId) const
+{
+    return setId >= 0 && setId < m_checked.size() && m_checked.testBit(setId);
+}
+
+int SetsModel::checkedCount() const
+{
+    return m_checked.count(true);
+}
+
+QStringList SetsModel::sets() const
+{
+    QStringList result;
+    result.reserve(m_rows.size());
+    for (const int id : m_rows)
+        result.append(StringPool::string(id));
+    return result;
+}
+
+QStringList SetsModel::checkedSets() const
+{
+    QStringList result;
+    for (const int id : m_rows) {
+        if (m_checked.testBit(id))
+            result.append(StringPool::string(id));
+    }
+    return result;
+}
+
+int SetsModel::internSet(const QString &set)
+{
+    const int id = StringPool::intern(set);
+    if (id >= m_checked.size())
+        m_checked.resize(id + 1);
+    return id;
+}
@@ -0,0 +1,59 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef SETSMODEL_H
+#define SETSMODEL_H
+#include <QAbstractListModel>
+#include <QBitArray>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+// The sets offered by MTGAHelper, one checkable row each.
+// Sets are identified by the StringPool id of their code, the same id the cards carry,
+// the checked sets are a bitset indexed by those ids.
+class SetsModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(SetsModel)
+public:
+    enum SetsModelRoles { SetCodeRole = Qt::UserRole, SetIdRole };
+    explicit SetsModel(QObject *parent = nullptr);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    // replaces the rows, none of them checked
+    void setSets(const QStringList &sets);
+    void setSetNames(const QHash<QString, QString> &setNames);
+    void setChecked(int row, bool checked);
+    void setAllChecked(bool checked);
+    // -1 if the code was never interned
+    int setId(const QString &set) const;
+    bool isChecked(int setId) const;
+    int checkedCount() const;
+    // codes of the sets in row order
+    QStringList sets() const;
+    // codes of the checked sets in row order
+    QStringList checkedSets() const;
+signals:
+    void setCheckChanged(int setId, bool checked);
+
+private:
+    int internSet(const QString &set);
+    QHash<int, QString> m_names;
+    QBitArray m_checked;
+    QVector<int> m_rows;
+};
+
+#endif
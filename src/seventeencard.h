@@ -13,7 +13,10 @@
 
 #ifndef SEVENTEENCARD_H
 #define SEVENTEENCARD_H
+#include "slmetrics.h"
+#include <QMetaType>
 #include <QString>
+class QDataStream;
 class SeventeenCard
 {
 public:
@@ -25,22 +28,11 @@ public:
     bool operator!=(const SeventeenCard &other) const { return !operator==(other); }
 
 public:
-    int seen_count;
-    double avg_seen;
-    int pick_count;
-    double avg_pick;
-    int game_count;
-    double win_rate;
-    int opening_hand_game_count;
-    double opening_hand_win_rate;
-    int drawn_game_count;
-    double drawn_win_rate;
-    int ever_drawn_game_count;
-    double ever_drawn_win_rate;
-    int never_drawn_game_count;
-    double never_drawn_win_rate;
-    double drawn_improvement_win_rate;
+    double metrics[SLCount];
     QString name;
 };
+Q_DECLARE_METATYPE(SeventeenCard)
 size_t qHash(const SeventeenCard &card, size_t seed = 0);
+QDataStream &operator<<(QDataStream &stream, const SeventeenCard &card);
+QDataStream &operator>>(QDataStream &stream, SeventeenCard &card);
 #endif
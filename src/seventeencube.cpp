@@ -0,0 +1,119 @@
+#include "seventeencube.h"
+
+const QStringList &SeventeenCube::formats()
+{
+    static const QStringList result{QStringLiteral("PremierDraft"), QStringLiteral("QuickDraft"), QStringLiteral("TradDraft"),
+                                    QStringLiteral("Sealed"), QStringLiteral("TradSealed")};
+    return result;
+}
+
+const QStringList &SeventeenCube::colorFilters()
+{
+    static const QStringList result{QString(),           QStringLiteral("WU"), QStringLiteral("WB"), QStringLiteral("WR"),
+                                    QStringLiteral("WG"), QStringLiteral("UB"), QStringLiteral("UR"), QStringLiteral("UG"),
+                                    QStringLiteral("BR"), QStringLiteral("BG"), QStringLiteral("RG")};
+    return result;
+}
+
+QString SeventeenCube::formatCode(const QString &format)
+{
+    static const QHash<QString, QString> codes{{QStringLiteral("PremierDraft"), QStringLiteral("PD")},
+                                               {QStringLiteral("QuickDraft"), QStringLiteral("QD")},
+                                               {QStringLiteral("TradDraft"), QStringLiteral("TD")},
+                                               {QStringLiteral("Sealed"), QStringLiteral("SD")},
+                                               {QStringLiteral("TradSealed"), QStringLiteral("TS")}};
+    return codes.value(format, format);
+}
+
+QString SeventeenCube::key(const QString &set, const QString &format, const QString &colors)
+{
+    return set + QLatin1Char('/') + format + QLatin1Char('/') + colors;
+}
+
+int SeventeenCube::size() const
+{
+    return m_slices.size();
+}
+
+bool SeventeenCube::isEmpty() const
+{
+    return m_slices.isEmpty();
+}
+
+void SeventeenCube::clear()
+{
+    m_slices.clear();
+}
+
+void SeventeenCube::insert(const QString &set, const QString &format, const QString &colors, const SeventeenTable &ratings)
+{
+    m_slices.insert(key(set, format, colors), ratings);
+}
+
+const SeventeenTable *SeventeenCube::slice(const QString &set, const QString &format, const QString &colors) const
+{
+    const auto sliceIter = m_slices.constFind(key(set, format, colors));
+    if (sliceIter == m_slices.constEnd())
+        return nullptr;
+    return &sliceIter.value();
+}
+
+bool SeventeenCube::bestArchetype(const QString &set, const QString &format, const QString &name, int metric, int minGames, QString &colors,
+                                  double &value) const
+{
+    bool found = false;
+    for (const QString &colorFilter : colorFilters()) {
+        if (colorFilter.isEmpty())
+            continue;
+        const SeventeenTable *table = slice(set, format, colorFilter);
+        if (!table)
+            continue;
+        const int row = table->indexOf(name);
+        if (row < 0 || table->intValue(SLgame_count, row) < minGames)
+            continue;
+        const double candidate = table->value(metric, row);
+        if (!found || candidate > value) {
+            found = true;
+            colors = colorFilter;
+            value = candidate;
+        }
+    }
+    return found;
+}
+
+SeventeenTable SeventeenCube::blendFormats(const QString &set, const QStringList &formats) const
+{
+    QVector<SeventeenCard> cards;
+    QVector<double> weights;
+    QHash<QString, int> cardIndex;
+    for (const QString &format : formats) {
+        const SeventeenTable *table = slice(set, format);
+        if (!table)
+            continue;
+        for (int row = 0, rowEnd = table->size(); row < rowEnd; ++row) {
+            auto indexIter = cardIndex.constFind(table->name(row));
+            if (indexIter == cardIndex.constEnd()) {
+                indexIter = cardIndex.insert(table->name(row), cards.size());
+                SeventeenCard card;
+                card.name = table->name(row);
+                cards.append(card);
+                weights.append(0.0);
+            }
+            SeventeenCard &card = cards[indexIter.value()];
+            const double weight = table->intValue(SLgame_count, row);
+            const double totalWeight = weights.at(indexIter.value()) + weight;
+            for (int i = 0; i < SLCount; ++i) {
+                if (slMetricIsInteger(i))
+                    card.metrics[i] += table->intValue(i, row);
+                else if (totalWeight > 0.0)
+                    card.metrics[i] += (table->doubleValue(i, row) - card.metrics[i]) * weight / totalWeight;
+            }
+            weights[indexIter.value()] = totalWeight;
+        }
+    }
+    SeventeenTable result;
+    result.reserve(cards.size());
+    for (const SeventeenCard &card : cards)
+        result.append(card);
+    return result;
+}
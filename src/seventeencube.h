@@ -0,0 +1,46 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef SEVENTEENCUBE_H
+#define SEVENTEENCUBE_H
+#include "seventeentable.h"
+#include <QHash>
+#include <QString>
+#include <QStringList>
+// 17Lands statistics of several sets sliced by format and by the colors of the decks (empty colors means all decks)
+class SeventeenCube
+{
+public:
+    enum { DefaultMinGames = 200 };
+    static const QStringList &formats();
+    static const QStringList &colorFilters();
+    static QString formatCode(const QString &format);
+    int size() const;
+    bool isEmpty() const;
+    void clear();
+    void insert(const QString &set, const QString &format, const QString &colors, const SeventeenTable &ratings);
+    // nullptr if the slice was not downloaded
+    const SeventeenTable *slice(const QString &set, const QString &format, const QString &colors = QString()) const;
+    // two color slice where the card has the highest value of metric, slices with less than minGames games are ignored
+    bool bestArchetype(const QString &set, const QString &format, const QString &name, int metric, int minGames, QString &colors,
+                       double &value) const;
+    // statistics of the set over several formats, counts are summed and rates weighted by the games of each format
+    SeventeenTable blendFormats(const QString &set, const QStringList &formats) const;
+
+private:
+    static QString key(const QString &set, const QString &format, const QString &colors);
+    QHash<QString, SeventeenTable> m_slices;
+};
+
+#endif
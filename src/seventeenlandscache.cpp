@@ -0,0 +1,243 @@
+#include "seventeenlandscache.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+namespace {
+const quint32 cacheMagic = 0x17CAC4E0;
+const quint16 cacheVersion = 2;
+}
+
+SeventeenLandsCache::Entry::Entry()
+    : fresh(false)
+{ }
+
+SeventeenLandsCache::IndexEntry::IndexEntry()
+    : fetched(0)
+    , changed(0)
+    , lastAccess(0)
+    , size(0)
+{ }
+
+SeventeenLandsCache::SeventeenLandsCache(const QString &directory)
+    : m_directory(directory)
+    , m_maxAge(60 * 60)
+    , m_frozenMaxAge(30 * 24 * 60 * 60)
+    , m_frozenAfter(7 * 24 * 60 * 60)
+    , m_sizeBudget(64 * 1024 * 1024)
+    , m_indexDirty(false)
+{
+    if (m_directory.isEmpty())
+        m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/17lands");
+    QDir().mkpath(m_directory);
+    loadIndex();
+}
+
+SeventeenLandsCache::~SeventeenLandsCache()
+{
+    if (m_indexDirty)
+        saveIndex();
+}
+
+QString SeventeenLandsCache::key(const QString &set, const QString &format, const QString &colors)
+{
+    const QString result = set + QLatin1Char('/') + format;
+    if (colors.isEmpty())
+        return result;
+    return result + QLatin1Char('/') + colors;
+}
+
+void SeventeenLandsCache::setMaxAge(qint64 seconds)
+{
+    m_maxAge = seconds;
+}
+
+void SeventeenLandsCache::setFrozenMaxAge(qint64 seconds)
+{
+    m_frozenMaxAge = seconds;
+}
+
+void SeventeenLandsCache::setFrozenAfter(qint64 seconds)
+{
+    m_frozenAfter = seconds;
+}
+
+void SeventeenLandsCache::setSizeBudget(qint64 bytes)
+{
+    m_sizeBudget = bytes;
+    prune();
+    saveIndex();
+}
+
+bool SeventeenLandsCache::lookup(const QString &key, Entry &entry)
+{
+    auto indexIter = m_index.find(key);
+    if (indexIter == m_index.end())
+        return false;
+    QFile cacheFile(m_directory + QLatin1Char('/') + indexIter->fileName);
+    if (!cacheFile.open(QIODevice::ReadOnly)) {
+        remove(key);
+        saveIndex();
+        return false;
+    }
+    QByteArray payload = qUncompress(cacheFile.readAll());
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if (magic != cacheMagic || version != cacheVersion) {
+        remove(key);
+        saveIndex();
+        return false;
+    }
+    entry.ratings.clear();
+    stream >> entry.ratings;
+    if (stream.status() != QDataStream::Ok) {
+        remove(key);
+        saveIndex();
+        return false;
+    }
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const qint64 maxAge = now - indexIter->changed >= m_frozenAfter ? m_frozenMaxAge : m_maxAge;
+    entry.fresh = now - indexIter->fetched < maxAge;
+    entry.etag = indexIter->etag;
+    entry.lastModified = indexIter->lastModified;
+    indexIter->lastAccess = now;
+    m_indexDirty = true;
+    return true;
+}
+
+void SeventeenLandsCache::store(const QString &key, const SeventeenTable &ratings, const QByteArray &etag, const QByteArray &lastModified)
+{
+    QByteArray payload;
+    {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream << cacheMagic << cacheVersion << ratings;
+    }
+    const QByteArray contentHash = QCryptographicHash::hash(payload, QCryptographicHash::Sha1);
+    const QByteArray compressed = qCompress(payload);
+    const QString fileName = QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex()) + QLatin1String(".bin");
+    QSaveFile cacheFile(m_directory + QLatin1Char('/') + fileName);
+    if (!cacheFile.open(QIODevice::WriteOnly) || cacheFile.write(compressed) != compressed.size() || !cacheFile.commit())
+        return;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    IndexEntry &indexEntry = m_index[key];
+    if (indexEntry.contentHash != contentHash)
+        indexEntry.changed = now;
+    indexEntry.fileName = fileName;
+    indexEntry.etag = etag;
+    indexEntry.lastModified = lastModified;
+    indexEntry.contentHash = contentHash;
+    indexEntry.fetched = now;
+    indexEntry.lastAccess = now;
+    indexEntry.size = compressed.size();
+    prune();
+    saveIndex();
+}
+
+void SeventeenLandsCache::markRevalidated(const QString &key, const QByteArray &etag, const QByteArray &lastModified)
+{
+    auto indexIter = m_index.find(key);
+    if (indexIter == m_index.end())
+        return;
+    indexIter->fetched = QDateTime::currentSecsSinceEpoch();
+    if (!etag.isEmpty())
+        indexIter->etag = etag;
+    if (!lastModified.isEmpty())
+        indexIter->lastModified = lastModified;
+    saveIndex();
+}
+
+void SeventeenLandsCache::clear()
+{
+    for (auto i = m_index.cbegin(), iEnd = m_index.cend(); i != iEnd; ++i)
+        QFile::remove(m_directory + QLatin1Char('/') + i->fileName);
+    m_index.clear();
+    saveIndex();
+}
+
+void SeventeenLandsCache::loadIndex()
+{
+    QFile indexFile(m_directory + QLatin1String("/index.json"));
+    if (!indexFile.open(QIODevice::ReadOnly))
+        return;
+    const QJsonDocument indexDocument = QJsonDocument::fromJson(indexFile.readAll());
+    const QJsonArray indexArray = indexDocument.object()[QLatin1String("entries")].toArray();
+    for (auto i = indexArray.cbegin(), iEnd = indexArray.cend(); i != iEnd; ++i) {
+        const QJsonObject entryObject = i->toObject();
+        const QString key = entryObject[QLatin1String("key")].toString();
+        IndexEntry entry;
+        entry.fileName = entryObject[QLatin1String("file")].toString();
+        if (key.isEmpty() || entry.fileName.isEmpty())
+            continue;
+        entry.etag = entryObject[QLatin1String("etag")].toString().toLatin1();
+        entry.lastModified = entryObject[QLatin1String("lastModified")].toString().toLatin1();
+        entry.contentHash = QByteArray::fromHex(entryObject[QLatin1String("hash")].toString().toLatin1());
+        entry.fetched = static_cast<qint64>(entryObject[QLatin1String("fetched")].toDouble());
+        entry.changed = static_cast<qint64>(entryObject[QLatin1String("changed")].toDouble());
+        entry.lastAccess = static_cast<qint64>(entryObject[QLatin1String("lastAccess")].toDouble());
+        entry.size = static_cast<qint64>(entryObject[QLatin1String("size")].toDouble());
+        m_index.insert(key, entry);
+    }
+}
+
+void SeventeenLandsCache::saveIndex()
+{
+    m_indexDirty = false;
+    QJsonArray indexArray;
+    for (auto i = m_index.cbegin(), iEnd = m_index.cend(); i != iEnd; ++i) {
+        QJsonObject entryObject;
+        entryObject[QLatin1String("key")] = i.key();
+        entryObject[QLatin1String("file")] = i->fileName;
+        entryObject[QLatin1String("etag")] = QString::fromLatin1(i->etag);
+        entryObject[QLatin1String("lastModified")] = QString::fromLatin1(i->lastModified);
+        entryObject[QLatin1String("hash")] = QString::fromLatin1(i->contentHash.toHex());
+        entryObject[QLatin1String("fetched")] = static_cast<double>(i->fetched);
+        entryObject[QLatin1String("changed")] = static_cast<double>(i->changed);
+        entryObject[QLatin1String("lastAccess")] = static_cast<double>(i->lastAccess);
+        entryObject[QLatin1String("size")] = static_cast<double>(i->size);
+        indexArray.append(entryObject);
+    }
+    QJsonObject indexObject;
+    indexObject[QLatin1String("entries")] = indexArray;
+    QSaveFile indexFile(m_directory + QLatin1String("/index.json"));
+    if (!indexFile.open(QIODevice::WriteOnly))
+        return;
+    indexFile.write(QJsonDocument(indexObject).toJson(QJsonDocument::Compact));
+    indexFile.commit();
+}
+
+void SeventeenLandsCache::remove(const QString &key)
+{
+    auto indexIter = m_index.find(key);
+    if (indexIter == m_index.end())
+        return;
+    QFile::remove(m_directory + QLatin1Char('/') + indexIter->fileName);
+    m_index.erase(indexIter);
+}
+
+void SeventeenLandsCache::prune()
+{
+    qint64 totalSize = 0;
+    QList<std::pair<qint64, QString>> accessOrder;
+    for (auto i = m_index.cbegin(), iEnd = m_index.cend(); i != iEnd; ++i) {
+        totalSize += i->size;
+        accessOrder.append(std::make_pair(i->lastAccess, i.key()));
+    }
+    if (totalSize <= m_sizeBudget)
+        return;
+    std::sort(accessOrder.begin(), accessOrder.end());
+    for (auto i = accessOrder.cbegin(), iEnd = accessOrder.cend(); i != iEnd && totalSize > m_sizeBudget; ++i) {
+        totalSize -= m_index.value(i->second).size;
+        remove(i->second);
+    }
+}
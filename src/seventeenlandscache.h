@@ -0,0 +1,75 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+#ifndef SEVENTEENLANDSCACHE_H
+#define SEVENTEENLANDSCACHE_H
+#include "seventeentable.h"
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+// Disk cache of parsed 17Lands ratings keyed by set, format and deck colors.
+// Payloads are stored compressed, evicted least recently used first once the size budget is exceeded.
+// Access times only touched by lookups are written with the next change of the index or on destruction.
+// Entries younger than maxAge are served without revalidation; sets whose data did not change for
+// frozenAfter seconds are considered frozen and use frozenMaxAge instead.
+class SeventeenLandsCache
+{
+    Q_DISABLE_COPY_MOVE(SeventeenLandsCache)
+public:
+    struct Entry
+    {
+        Entry();
+        SeventeenTable ratings;
+        QByteArray etag;
+        QByteArray lastModified;
+        bool fresh;
+    };
+    explicit SeventeenLandsCache(const QString &directory = QString());
+    ~SeventeenLandsCache();
+    static QString key(const QString &set, const QString &format, const QString &colors = QString());
+    void setMaxAge(qint64 seconds);
+    void setFrozenMaxAge(qint64 seconds);
+    void setFrozenAfter(qint64 seconds);
+    void setSizeBudget(qint64 bytes);
+    bool lookup(const QString &key, Entry &entry);
+    void store(const QString &key, const SeventeenTable &ratings, const QByteArray &etag, const QByteArray &lastModified);
+    void markRevalidated(const QString &key, const QByteArray &etag, const QByteArray &lastModified);
+    void clear();
+
+private:
+    struct IndexEntry
+    {
+        IndexEntry();
+        QString fileName;
+        QByteArray etag;
+        QByteArray lastModified;
+        QByteArray contentHash;
+        qint64 fetched;
+        qint64 changed;
+        qint64 lastAccess;
+        qint64 size;
+    };
+    void loadIndex();
+    void saveIndex();
+    void remove(const QString &key);
+    void prune();
+    QString m_directory;
+    QHash<QString, IndexEntry> m_index;
+    qint64 m_maxAge;
+    qint64 m_frozenMaxAge;
+    qint64 m_frozenAfter;
+    qint64 m_sizeBudget;
+    bool m_indexDirty;
+};
+
+#endif
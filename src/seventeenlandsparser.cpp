@@ -0,0 +1,271 @@
+#include "seventeenlandsparser.h"
+#include <QHash>
+#include <QString>
+namespace {
+// SLCount identifies the name field, any other non-negative value is the metric the key holds
+const int nameField = SLCount;
+
+int recordField(const char *key, int size)
+{
+    static const QHash<QByteArray, int> fields = []() -> QHash<QByteArray, int> {
+        QHash<QByteArray, int> result;
+        result.insert(QByteArrayLiteral("name"), nameField);
+        for (int i = 0; i < SLCount; ++i)
+            result.insert(QByteArray(slMetricDescriptors[i].jsonKey), i);
+        return result;
+    }();
+    return fields.value(QByteArray::fromRawData(key, size), -1);
+}
+
+bool isJsonSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+const char *skipSpaces(const char *p, const char *end)
+{
+    while (p != end && isJsonSpace(*p))
+        ++p;
+    return p;
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// p points after the opening quote, returns the position after the closing quote or nullptr on error
+const char *readString(const char *p, const char *end, QString *result)
+{
+    const char *runStart = p;
+    for (; p != end; ++p) {
+        if (*p == '"') {
+            if (result)
+                result->append(QString::fromUtf8(runStart, p - runStart));
+            return p + 1;
+        }
+        if (*p != '\\')
+            continue;
+        if (result)
+            result->append(QString::fromUtf8(runStart, p - runStart));
+        if (++p == end)
+            return nullptr;
+        QChar escaped;
+        switch (*p) {
+        case '"':
+        case '\\':
+        case '/':
+            escaped = QLatin1Char(*p);
+            break;
+        case 'b':
+            escaped = QLatin1Char('\b');
+            break;
+        case 'f':
+            escaped = QLatin1Char('\f');
+            break;
+        case 'n':
+            escaped = QLatin1Char('\n');
+            break;
+        case 'r':
+            escaped = QLatin1Char('\r');
+            break;
+        case 't':
+            escaped = QLatin1Char('\t');
+            break;
+        case 'u': {
+            if (end - p < 5)
+                return nullptr;
+            int code = 0;
+            for (int i = 1; i <= 4; ++i) {
+                const int digit = hexValue(p[i]);
+                if (digit < 0)
+                    return nullptr;
+                code = (code << 4) | digit;
+            }
+            p += 4;
+            escaped = QChar(static_cast<char16_t>(code));
+            break;
+        }
+        default:
+            return nullptr;
+        }
+        if (result)
+            result->append(escaped);
+        runStart = p + 1;
+    }
+    return nullptr;
+}
+
+// skips a nested object or array, p points at the opening bracket
+const char *skipNested(const char *p, const char *end)
+{
+    int depth = 0;
+    while (p != end) {
+        switch (*p) {
+        case '"':
+            p = readString(p + 1, end, nullptr);
+            if (!p)
+                return nullptr;
+            continue;
+        case '{':
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            if (--depth == 0)
+                return p + 1;
+            break;
+        default:
+            break;
+        }
+        ++p;
+    }
+    return nullptr;
+}
+}
+
+SeventeenLandsParser::SeventeenLandsParser(const std::function<void(const SeventeenCard &)> &onCard)
+    : m_onCard(onCard)
+{
+    reset();
+}
+
+void SeventeenLandsParser::reset()
+{
+    m_buffer.clear();
+    m_scanPos = 0;
+    m_recordStart = -1;
+    m_depth = 0;
+    m_inString = false;
+    m_escape = false;
+    m_started = false;
+    m_status = Incomplete;
+}
+
+SeventeenLandsParser::Status SeventeenLandsParser::status() const
+{
+    return m_status;
+}
+
+SeventeenLandsParser::Status SeventeenLandsParser::addData(const QByteArray &data)
+{
+    if (m_status != Incomplete)
+        return m_status;
+    m_buffer.append(data);
+    const char *const bufferData = m_buffer.constData();
+    const int bufferSize = m_buffer.size();
+    int pos = m_scanPos;
+    for (; pos < bufferSize && m_status == Incomplete; ++pos) {
+        const char c = bufferData[pos];
+        if (m_inString) {
+            if (m_escape)
+                m_escape = false;
+            else if (c == '\\')
+                m_escape = true;
+            else if (c == '"')
+                m_inString = false;
+            continue;
+        }
+        if (isJsonSpace(c))
+            continue;
+        if (m_depth == 0) {
+            if (c != '[' || m_started)
+                m_status = Error;
+            m_started = true;
+            m_depth = 1;
+            continue;
+        }
+        switch (c) {
+        case '"':
+            m_inString = true;
+            break;
+        case '{':
+        case '[':
+            if (m_depth++ == 1)
+                m_recordStart = c == '{' ? pos : -1;
+            break;
+        case '}':
+        case ']':
+            if (--m_depth == 0) {
+                m_status = Finished;
+            } else if (m_depth == 1 && m_recordStart >= 0) {
+                SeventeenCard card;
+                if (!parseRecord(bufferData + m_recordStart, bufferData + pos + 1, card))
+                    m_status = Error;
+                else if (!card.name.isEmpty())
+                    m_onCard(card);
+                m_recordStart = -1;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    int consumed = pos;
+    if (m_recordStart >= 0) {
+        consumed = m_recordStart;
+        m_recordStart = 0;
+    }
+    m_buffer.remove(0, consumed);
+    m_scanPos = pos - consumed;
+    return m_status;
+}
+
+bool SeventeenLandsParser::parseRecord(const char *p, const char *end, SeventeenCard &card) const
+{
+    Q_ASSERT(*p == '{');
+    p = skipSpaces(p + 1, end);
+    if (p != end && *p == '}')
+        return true;
+    while (p != end) {
+        if (*p != '"')
+            return false;
+        const char *keyBegin = p + 1;
+        p = readString(keyBegin, end, nullptr);
+        if (!p)
+            return false;
+        const int field = recordField(keyBegin, static_cast<int>(p - keyBegin - 1));
+        p = skipSpaces(p, end);
+        if (p == end || *p != ':')
+            return false;
+        p = skipSpaces(p + 1, end);
+        if (p == end)
+            return false;
+        if (*p == '"') {
+            QString value;
+            p = readString(p + 1, end, field == nameField ? &value : nullptr);
+            if (!p)
+                return false;
+            if (field == nameField)
+                card.name = value;
+        } else if (*p == '{' || *p == '[') {
+            p = skipNested(p, end);
+            if (!p)
+                return false;
+        } else {
+            const char *valueBegin = p;
+            while (p != end && *p != ',' && *p != '}' && !isJsonSpace(*p))
+                ++p;
+            bool isNumber = false;
+            const double value = QByteArray::fromRawData(valueBegin, static_cast<int>(p - valueBegin)).toDouble(&isNumber);
+            if (isNumber && field >= 0 && field < SLCount)
+                card.metrics[field] = value;
+        }
+        p = skipSpaces(p, end);
+        if (p == end)
+            return false;
+        if (*p == '}')
+            return true;
+        if (*p != ',')
+            return false;
+        p = skipSpaces(p + 1, end);
+    }
+    return false;
+}
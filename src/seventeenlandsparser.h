@@ -0,0 +1,44 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+#ifndef SEVENTEENLANDSPARSER_H
+#define SEVENTEENLANDSPARSER_H
+#include "seventeencard.h"
+#include <QByteArray>
+#include <functional>
+// Incremental decoder for the 17Lands card_ratings payload (a JSON array of flat objects).
+// Only the record currently being received is buffered; every completed record is handed to the callback.
+class SeventeenLandsParser
+{
+    Q_DISABLE_COPY_MOVE(SeventeenLandsParser)
+public:
+    enum Status { Incomplete, Finished, Error };
+    explicit SeventeenLandsParser(const std::function<void(const SeventeenCard &)> &onCard);
+    Status addData(const QByteArray &data);
+    Status status() const;
+    void reset();
+
+private:
+    bool parseRecord(const char *begin, const char *end, SeventeenCard &card) const;
+    std::function<void(const SeventeenCard &)> m_onCard;
+    QByteArray m_buffer;
+    int m_scanPos;
+    int m_recordStart;
+    int m_depth;
+    bool m_inString;
+    bool m_escape;
+    bool m_started;
+    Status m_status;
+};
+
+#endif
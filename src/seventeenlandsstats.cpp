@@ -0,0 +1,48 @@
+#include "seventeenlandsstats.h"
+SeventeenLandsStats::SeventeenLandsStats() { }
+
+void SeventeenLandsStats::insert(const QString &set, const SeventeenTable &table)
+{
+    SetStats &setStats = m_sets[set];
+    setStats.table = table;
+    setStats.ratings.clear();
+}
+
+void SeventeenLandsStats::clear()
+{
+    m_sets.clear();
+}
+
+bool SeventeenLandsStats::isEmpty() const
+{
+    return m_sets.isEmpty();
+}
+
+bool SeventeenLandsStats::contains(const QString &set) const
+{
+    return m_sets.contains(set);
+}
+
+QStringList SeventeenLandsStats::sets() const
+{
+    return m_sets.keys();
+}
+
+SeventeenTable SeventeenLandsStats::table(const QString &set) const
+{
+    return m_sets.value(set).table;
+}
+
+QVector<char> SeventeenLandsStats::ratings(const QString &set, int metric, SeventeenTable::Normalization normalization) const
+{
+    const auto setIter = m_sets.constFind(set);
+    if (setIter == m_sets.constEnd())
+        return QVector<char>();
+    const int key = metric * SeventeenTable::NormalizationCount + normalization;
+    const auto ratingsIter = setIter->ratings.constFind(key);
+    if (ratingsIter != setIter->ratings.constEnd())
+        return ratingsIter.value();
+    const QVector<char> result = setIter->table.normalizedRatings(metric, normalization);
+    setIter->ratings.insert(key, result);
+    return result;
+}
@@ -0,0 +1,48 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef SEVENTEENLANDSSTATS_H
+#define SEVENTEENLANDSSTATS_H
+#include "seventeentable.h"
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+// 17Lands statistics of the downloaded sets kept in memory so the ratings can be computed again
+// for another metric or normalization without downloading anything.
+// The normalized ratings are computed once per set, metric and normalization.
+class SeventeenLandsStats
+{
+public:
+    SeventeenLandsStats();
+    void insert(const QString &set, const SeventeenTable &table);
+    void clear();
+    bool isEmpty() const;
+    bool contains(const QString &set) const;
+    QStringList sets() const;
+    // empty if the set was never inserted
+    SeventeenTable table(const QString &set) const;
+    QVector<char> ratings(const QString &set, int metric, SeventeenTable::Normalization normalization) const;
+
+private:
+    struct SetStats
+    {
+        SeventeenTable table;
+        // filled lazily by the const ratings()
+        mutable QHash<int, QVector<char>> ratings;
+    };
+    QHash<QString, SetStats> m_sets;
+};
+
+#endif
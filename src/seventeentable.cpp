@@ -0,0 +1,269 @@
+#include "seventeentable.h"
+#include "stringpool.h"
+#include <QDataStream>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+namespace {
+template<class T>
+std::pair<double, double> columnMinMax(const QVector<T> &column)
+{
+    if (column.isEmpty())
+        return std::make_pair(0.0, 0.0);
+    const T *i = column.constData();
+    const T *const iEnd = i + column.size();
+    T minValue = *i;
+    T maxValue = *i;
+    for (++i; i != iEnd; ++i) {
+        minValue = std::min(minValue, *i);
+        maxValue = std::max(maxValue, *i);
+    }
+    return std::make_pair(static_cast<double>(minValue), static_cast<double>(maxValue));
+}
+
+template<class T>
+void normalizeColumn(const QVector<T> &column, double minValue, double maxValue, char *result)
+{
+    double denominator = maxValue - minValue;
+    if (denominator == 0.0)
+        denominator = 1.0;
+    const T *const values = column.constData();
+    for (int i = 0, iEnd = column.size(); i < iEnd; ++i)
+        result[i] = static_cast<char>(qRound(10.0 * (values[i] - minValue) / denominator));
+}
+
+// ties get the average of their ranks so equal values always get the same rating
+void percentileRanks(const QVector<double> &values, char *result)
+{
+    const int count = values.size();
+    if (count == 1) {
+        result[0] = 5;
+        return;
+    }
+    QVector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&values](int a, int b) { return values.at(a) < values.at(b); });
+    for (int first = 0; first < count;) {
+        int last = first + 1;
+        while (last < count && values.at(order.at(last)) == values.at(order.at(first)))
+            ++last;
+        const char rating = static_cast<char>(qRound(10.0 * (first + last - 1) / (2.0 * (count - 1))));
+        for (; first < last; ++first)
+            result[order.at(first)] = rating;
+    }
+}
+
+// two standard deviations either side of the mean cover the whole range
+void zScores(const QVector<double> &values, char *result)
+{
+    const int count = values.size();
+    const double mean = std::accumulate(values.cbegin(), values.cend(), 0.0) / count;
+    double variance = 0.0;
+    for (const double value : values)
+        variance += (value - mean) * (value - mean);
+    const double deviation = std::sqrt(variance / count);
+    for (int i = 0; i < count; ++i) {
+        const double zScore = deviation > 0.0 ? (values.at(i) - mean) / deviation : 0.0;
+        result[i] = static_cast<char>(qRound(5.0 + 2.5 * std::max(-2.0, std::min(2.0, zScore))));
+    }
+}
+}
+
+SeventeenTable::SeventeenTable() { }
+
+int SeventeenTable::size() const
+{
+    return m_names.size();
+}
+
+bool SeventeenTable::isEmpty() const
+{
+    return m_names.isEmpty();
+}
+
+void SeventeenTable::clear()
+{
+    m_names.clear();
+    m_nameIndex.clear();
+    for (int i = 0; i < SLCount; ++i) {
+        m_intColumns[i].clear();
+        m_doubleColumns[i].clear();
+    }
+}
+
+void SeventeenTable::reserve(int size)
+{
+    m_names.reserve(size);
+    m_nameIndex.reserve(size);
+    for (int i = 0; i < SLCount; ++i) {
+        if (slMetricIsInteger(i))
+            m_intColumns[i].reserve(size);
+        else
+            m_doubleColumns[i].reserve(size);
+    }
+}
+
+// cards are identified by name, appending a name already in the table does nothing and returns false
+bool SeventeenTable::append(const SeventeenCard &card)
+{
+    const int nameId = StringPool::intern(card.name);
+    if (m_nameIndex.contains(nameId))
+        return false;
+    m_nameIndex.insert(nameId, m_names.size());
+    m_names.append(StringPool::shared(card.name));
+    for (int i = 0; i < SLCount; ++i)
+        appendValue(i, card.metrics[i]);
+    return true;
+}
+
+void SeventeenTable::appendValue(int metric, double value)
+{
+    if (slMetricIsInteger(metric))
+        m_intColumns[metric].append(static_cast<qint32>(value));
+    else
+        m_doubleColumns[metric].append(value);
+}
+
+const QString &SeventeenTable::name(int row) const
+{
+    return m_names.at(row);
+}
+
+int SeventeenTable::indexOf(const QString &name) const
+{
+    return indexOfNameId(StringPool::find(name));
+}
+
+int SeventeenTable::indexOfNameId(int nameId) const
+{
+    return m_nameIndex.value(nameId, -1);
+}
+
+qint32 SeventeenTable::intValue(int metric, int row) const
+{
+    Q_ASSERT(slMetricIsInteger(metric));
+    return m_intColumns[metric].at(row);
+}
+
+double SeventeenTable::doubleValue(int metric, int row) const
+{
+    Q_ASSERT(!slMetricIsInteger(metric));
+    return m_doubleColumns[metric].at(row);
+}
+
+double SeventeenTable::value(int metric, int row) const
+{
+    if (slMetricIsInteger(metric))
+        return m_intColumns[metric].at(row);
+    return m_doubleColumns[metric].at(row);
+}
+
+SeventeenCard SeventeenTable::card(int row) const
+{
+    SeventeenCard result(m_names.at(row));
+    for (int i = 0; i < SLCount; ++i)
+        result.metrics[i] = value(i, row);
+    return result;
+}
+
+std::pair<double, double> SeventeenTable::minMax(int metric) const
+{
+    if (metric < 0 || metric >= SLCount)
+        return std::make_pair(0.0, 0.0);
+    if (slMetricIsInteger(metric))
+        return columnMinMax(m_intColumns[metric]);
+    return columnMinMax(m_doubleColumns[metric]);
+}
+
+QVector<double> SeventeenTable::column(int metric) const
+{
+    if (!slMetricIsInteger(metric))
+        return m_doubleColumns[metric];
+    const QVector<qint32> &intColumn = m_intColumns[metric];
+    return QVector<double>(intColumn.cbegin(), intColumn.cend());
+}
+
+// normalization of the metric to the 0-10 rating range, one entry per row
+QVector<char> SeventeenTable::normalizedRatings(int metric, Normalization normalization) const
+{
+    if (metric < 0 || metric >= SLCount)
+        return QVector<char>();
+    QVector<char> result(size());
+    if (result.isEmpty())
+        return result;
+    // counts have no sample size to shrink by
+    if (normalization == ShrinkageNormalization && slMetricIsInteger(metric))
+        normalization = MinMaxNormalization;
+    switch (normalization) {
+    case PercentileNormalization:
+        percentileRanks(column(metric), result.data());
+        break;
+    case ZScoreNormalization:
+        zScores(column(metric), result.data());
+        break;
+    case ShrinkageNormalization: {
+        const QVector<double> &rates = m_doubleColumns[metric];
+        const QVector<qint32> &games = m_intColumns[SLgame_count];
+        double weightedSum = 0.0;
+        qint64 totalGames = 0;
+        for (int i = 0, iEnd = rates.size(); i < iEnd; ++i) {
+            weightedSum += rates.at(i) * games.at(i);
+            totalGames += games.at(i);
+        }
+        const double mean = totalGames > 0 ? weightedSum / totalGames : std::accumulate(rates.cbegin(), rates.cend(), 0.0) / rates.size();
+        QVector<double> shrunk(rates.size());
+        for (int i = 0, iEnd = rates.size(); i < iEnd; ++i)
+            shrunk[i] = (rates.at(i) * games.at(i) + mean * ShrinkagePriorGames) / (games.at(i) + ShrinkagePriorGames);
+        const std::pair<double, double> range = columnMinMax(shrunk);
+        normalizeColumn(shrunk, range.first, range.second, result.data());
+        break;
+    }
+    default: {
+        const std::pair<double, double> range = minMax(metric);
+        if (slMetricIsInteger(metric))
+            normalizeColumn(m_intColumns[metric], range.first, range.second, result.data());
+        else
+            normalizeColumn(m_doubleColumns[metric], range.first, range.second, result.data());
+        break;
+    }
+    }
+    return result;
+}
+
+QDataStream &operator<<(QDataStream &stream, const SeventeenTable &table)
+{
+    stream << table.m_names;
+    for (int i = 0; i < SLCount; ++i) {
+        if (slMetricIsInteger(i))
+            stream << table.m_intColumns[i];
+        else
+            stream << table.m_doubleColumns[i];
+    }
+    return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, SeventeenTable &table)
+{
+    table.clear();
+    stream >> table.m_names;
+    for (int i = 0; i < SLCount; ++i) {
+        if (slMetricIsInteger(i))
+            stream >> table.m_intColumns[i];
+        else
+            stream >> table.m_doubleColumns[i];
+        const int columnSize = slMetricIsInteger(i) ? table.m_intColumns[i].size() : table.m_doubleColumns[i].size();
+        if (columnSize != table.m_names.size())
+            stream.setStatus(QDataStream::ReadCorruptData);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        table.clear();
+        return stream;
+    }
+    table.m_nameIndex.reserve(table.m_names.size());
+    for (int i = 0, iEnd = table.m_names.size(); i < iEnd; ++i) {
+        int nameId = -1;
+        table.m_names[i] = StringPool::shared(table.m_names.at(i), &nameId);
+        table.m_nameIndex.insert(nameId, i);
+    }
+    return stream;
+}
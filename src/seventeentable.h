@@ -0,0 +1,72 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+#ifndef SEVENTEENTABLE_H
+#define SEVENTEENTABLE_H
+#include "seventeencard.h"
+#include "slmetrics.h"
+#include <QHash>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+#include <utility>
+class QDataStream;
+// 17Lands statistics of a set stored column by column.
+// Count metrics are kept as 32 bit integers, rates as doubles, each in its own contiguous array.
+// Names are the copies of the StringPool and rows are indexed by their pool ids.
+class SeventeenTable
+{
+public:
+    // how a metric is mapped to the 0-10 rating range
+    enum Normalization {
+        MinMaxNormalization,
+        PercentileNormalization,
+        ZScoreNormalization,
+        // rates pulled toward the mean of the set by as many games as ShrinkagePriorGames, then min-max
+        ShrinkageNormalization,
+        NormalizationCount
+    };
+    enum { ShrinkagePriorGames = 200 };
+    SeventeenTable();
+    SeventeenTable(const SeventeenTable &other) = default;
+    SeventeenTable &operator=(const SeventeenTable &other) = default;
+    int size() const;
+    bool isEmpty() const;
+    void clear();
+    void reserve(int size);
+    bool append(const SeventeenCard &card);
+    const QString &name(int row) const;
+    int indexOf(const QString &name) const;
+    int indexOfNameId(int nameId) const;
+    qint32 intValue(int metric, int row) const;
+    double doubleValue(int metric, int row) const;
+    double value(int metric, int row) const;
+    SeventeenCard card(int row) const;
+    // both are empty if metric is not a SLMetrics value
+    std::pair<double, double> minMax(int metric) const;
+    QVector<char> normalizedRatings(int metric, Normalization normalization = MinMaxNormalization) const;
+    friend QDataStream &operator<<(QDataStream &stream, const SeventeenTable &table);
+    friend QDataStream &operator>>(QDataStream &stream, SeventeenTable &table);
+
+private:
+    void appendValue(int metric, double value);
+    QVector<double> column(int metric) const;
+    QVector<QString> m_names;
+    QHash<int, int> m_nameIndex;
+    QVector<qint32> m_intColumns[SLCount];
+    QVector<double> m_doubleColumns[SLCount];
+};
+Q_DECLARE_METATYPE(SeventeenTable)
+QDataStream &operator<<(QDataStream &stream, const SeventeenTable &table);
+QDataStream &operator>>(QDataStream &stream, SeventeenTable &table);
+#endif
@@ -0,0 +1,90 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+#ifndef SLMETRICS_H
+#define SLMETRICS_H
+#include <QtGlobal>
+enum SLMetrics {
+    SLseen_count,
+    SLavg_seen,
+    SLpick_count,
+    SLavg_pick,
+    SLgame_count,
+    SLwin_rate,
+    SLopening_hand_game_count,
+    SLopening_hand_win_rate,
+    SLdrawn_game_count,
+    SLdrawn_win_rate,
+    SLever_drawn_game_count,
+    SLever_drawn_win_rate,
+    SLnever_drawn_game_count,
+    SLnever_drawn_win_rate,
+    SLdrawn_improvement_win_rate
+
+    ,
+    SLCount
+};
+enum SLMetricType { SLIntegerMetric, SLRealMetric };
+struct SLMetricDescriptor
+{
+    const char *jsonKey;
+    const char *code;
+    const char *description;
+    SLMetricType type;
+    bool percent;
+    int precision;
+    bool inDefaultNote;
+};
+// code and description are translated in the "SLMetrics" context, description takes the code as %1
+constexpr SLMetricDescriptor slMetricDescriptors[] = {
+        {"seen_count", QT_TRANSLATE_NOOP("SLMetrics", "#S"), QT_TRANSLATE_NOOP("SLMetrics", "Number Seen (%1)"), SLIntegerMetric, false, 0, false},
+        {"avg_seen", QT_TRANSLATE_NOOP("SLMetrics", "ALSA"), QT_TRANSLATE_NOOP("SLMetrics", "Average Last Seen At (%1)"), SLRealMetric, false, 2,
+         false},
+        {"pick_count", QT_TRANSLATE_NOOP("SLMetrics", "#P"), QT_TRANSLATE_NOOP("SLMetrics", "Number Picked (%1)"), SLIntegerMetric, false, 0, false},
+        {"avg_pick", QT_TRANSLATE_NOOP("SLMetrics", "ATA"), QT_TRANSLATE_NOOP("SLMetrics", "Average Taken At (%1)"), SLRealMetric, false, 2, true},
+        {"game_count", QT_TRANSLATE_NOOP("SLMetrics", "#GP"), QT_TRANSLATE_NOOP("SLMetrics", "Number of Games Played (%1)"), SLIntegerMetric, false,
+         0, false},
+        {"win_rate", QT_TRANSLATE_NOOP("SLMetrics", "GPWR"), QT_TRANSLATE_NOOP("SLMetrics", "Games Played Win Rate (%1)"), SLRealMetric, true, 2,
+         false},
+        {"opening_hand_game_count", QT_TRANSLATE_NOOP("SLMetrics", "#OH"), QT_TRANSLATE_NOOP("SLMetrics", "Number of Games in Opening Hand (%1)"),
+         SLIntegerMetric, false, 0, false},
+        {"opening_hand_win_rate", QT_TRANSLATE_NOOP("SLMetrics", "OHWR"), QT_TRANSLATE_NOOP("SLMetrics", "Opening Hand Win Rate (%1)"), SLRealMetric,
+         true, 2, false},
+        {"drawn_game_count", QT_TRANSLATE_NOOP("SLMetrics", "#GD"), QT_TRANSLATE_NOOP("SLMetrics", "Number of Games Drawn (%1)"), SLIntegerMetric,
+         false, 0, false},
+        {"drawn_win_rate", QT_TRANSLATE_NOOP("SLMetrics", "GDWR"), QT_TRANSLATE_NOOP("SLMetrics", "Games Drawn Win Rate (%1)"), SLRealMetric, true, 2,
+         true},
+        {"ever_drawn_game_count", QT_TRANSLATE_NOOP("SLMetrics", "#GIH"), QT_TRANSLATE_NOOP("SLMetrics", "Number of Games In Hand (%1)"),
+         SLIntegerMetric, false, 0, false},
+        {"ever_drawn_win_rate", QT_TRANSLATE_NOOP("SLMetrics", "GIHWR"), QT_TRANSLATE_NOOP("SLMetrics", "Games in Hand Win Rate (%1)"), SLRealMetric,
+         true, 2, false},
+        {"never_drawn_game_count", QT_TRANSLATE_NOOP("SLMetrics", "#GND"), QT_TRANSLATE_NOOP("SLMetrics", "Number of Games Not Drawn (%1)"),
+         SLIntegerMetric, false, 0, false},
+        {"never_drawn_win_rate", QT_TRANSLATE_NOOP("SLMetrics", "GNDWR"), QT_TRANSLATE_NOOP("SLMetrics", "Games Not Drawn Win Rate (%1)"),
+         SLRealMetric, true, 2, false},
+        {"drawn_improvement_win_rate", QT_TRANSLATE_NOOP("SLMetrics", "IWD"), QT_TRANSLATE_NOOP("SLMetrics", "Improvement When Drawn (%1)"),
+         SLRealMetric, true, 2, false},
+};
+static_assert(sizeof(slMetricDescriptors) / sizeof(slMetricDescriptors[0]) == SLCount, "slMetricDescriptors must describe every SLMetrics value");
+static_assert(SLCount <= 32, "metric selections are stored as 32 bit masks");
+
+constexpr bool slMetricIsInteger(int metric)
+{
+    return slMetricDescriptors[metric].type == SLIntegerMetric;
+}
+
+constexpr quint32 slMetricBit(int metric)
+{
+    return quint32(1) << metric;
+}
+#endif
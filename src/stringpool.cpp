@@ -0,0 +1,95 @@
+#include "stringpool.h"
+#include <QHash>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QVector>
+#include <QWriteLocker>
+#include <atomic>
+namespace {
+struct PoolState
+{
+    QReadWriteLock lock;
+    QHash<QString, int> ids;
+    QVector<QString> strings;
+    std::atomic<qint64> lookups {0};
+    std::atomic<qint64> savedBytes {0};
+};
+
+PoolState &poolState()
+{
+    static PoolState state;
+    return state;
+}
+
+// id of the string, adding it if needed, and the pooled copy if pooled is not null
+int internString(const QString &string, QString *pooled)
+{
+    PoolState &state = poolState();
+    state.lookups.fetch_add(1, std::memory_order_relaxed);
+    {
+        QReadLocker locker(&state.lock);
+        const auto idIter = state.ids.constFind(string);
+        if (idIter != state.ids.constEnd()) {
+            if (pooled)
+                *pooled = state.strings.at(idIter.value());
+            return idIter.value();
+        }
+    }
+    QWriteLocker locker(&state.lock);
+    // another thread may have added it between the two locks
+    auto idIter = state.ids.constFind(string);
+    if (idIter == state.ids.constEnd()) {
+        idIter = state.ids.insert(string, state.strings.size());
+        state.strings.append(string);
+    }
+    if (pooled)
+        *pooled = state.strings.at(idIter.value());
+    return idIter.value();
+}
+}
+
+int StringPool::intern(const QString &string)
+{
+    return internString(string, nullptr);
+}
+
+int StringPool::find(const QString &string)
+{
+    PoolState &state = poolState();
+    QReadLocker locker(&state.lock);
+    return state.ids.value(string, -1);
+}
+
+QString StringPool::string(int id)
+{
+    PoolState &state = poolState();
+    QReadLocker locker(&state.lock);
+    if (id < 0 || id >= state.strings.size())
+        return QString();
+    return state.strings.at(id);
+}
+
+QString StringPool::shared(const QString &string, int *id)
+{
+    QString pooled;
+    const int stringId = internString(string, &pooled);
+    if (id)
+        *id = stringId;
+    // the caller keeps the pooled copy instead of its own, that is only a saving if they were different storage
+    if (!string.isSharedWith(pooled))
+        poolState().savedBytes.fetch_add(string.size() * qint64(sizeof(QChar)), std::memory_order_relaxed);
+    return pooled;
+}
+
+StringPool::Statistics StringPool::statistics()
+{
+    PoolState &state = poolState();
+    Statistics result;
+    {
+        QReadLocker locker(&state.lock);
+        result.strings = state.strings.size();
+    }
+    result.lookups = state.lookups.load(std::memory_order_relaxed);
+    result.savedBytes = state.savedBytes.load(std::memory_order_relaxed);
+    return result;
+}
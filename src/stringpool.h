@@ -0,0 +1,42 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+#include <QString>
+// Process-wide pool of the set codes and card names.
+// Every distinct string is stored once and gets a small id that never changes, so the card
+// structures share the same storage and joins and filters hash and compare ids instead of strings.
+// The pool is safe to use from any thread.
+class StringPool
+{
+public:
+    struct Statistics
+    {
+        int strings = 0;
+        qint64 lookups = 0;
+        // bytes of the copies callers dropped for the pooled one through shared()
+        qint64 savedBytes = 0;
+    };
+    // id of the string, adding it if needed
+    static int intern(const QString &string);
+    // -1 if the string was never interned
+    static int find(const QString &string);
+    static QString string(int id);
+    // the pooled copy of the string to store in place of string, shares the storage of every other copy.
+    // If id is not null it receives the id of the string
+    static QString shared(const QString &string, int *id = nullptr);
+    static Statistics statistics();
+};
+#endif
@@ -0,0 +1,225 @@
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QNetworkReply>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QThread>
+#include <QUrlQuery>
+#include <QVector>
+namespace {
+struct TraceEvent
+{
+    const char *name;
+    const char *category;
+    qint64 begin;
+    qint64 end;
+    quint64 asyncId;
+    int threadId;
+    QString set;
+    QString url;
+    int cards;
+};
+
+struct TraceState
+{
+    QMutex mutex;
+    QElapsedTimer clock;
+    QString fileName;
+    QVector<TraceEvent> events;
+    QHash<Qt::HANDLE, int> threadIds;
+    quint64 nextAsyncId = 1;
+};
+
+TraceState &traceState()
+{
+    static TraceState state;
+    return state;
+}
+
+// caller holds the mutex
+int threadId(TraceState &state)
+{
+    const Qt::HANDLE handle = QThread::currentThreadId();
+    auto idIter = state.threadIds.constFind(handle);
+    if (idIter == state.threadIds.constEnd())
+        idIter = state.threadIds.insert(handle, state.threadIds.size() + 1);
+    return idIter.value();
+}
+
+void appendEvent(TraceEvent event)
+{
+    TraceState &state = traceState();
+    QMutexLocker locker(&state.mutex);
+    event.threadId = threadId(state);
+    state.events.append(event);
+}
+
+QJsonObject eventObject(const TraceEvent &event, const char *phase, qint64 timestamp)
+{
+    QJsonObject result;
+    result[QLatin1String("name")] = QLatin1String(event.name);
+    result[QLatin1String("cat")] = QLatin1String(event.category);
+    result[QLatin1String("ph")] = QLatin1String(phase);
+    result[QLatin1String("ts")] = timestamp;
+    result[QLatin1String("pid")] = static_cast<qint64>(QCoreApplication::applicationPid());
+    result[QLatin1String("tid")] = event.threadId;
+    if (event.asyncId != 0)
+        result[QLatin1String("id")] = static_cast<qint64>(event.asyncId);
+    QJsonObject args;
+    if (!event.set.isEmpty())
+        args[QLatin1String("set")] = event.set;
+    if (!event.url.isEmpty())
+        args[QLatin1String("url")] = event.url;
+    if (event.cards >= 0)
+        args[QLatin1String("cards")] = event.cards;
+    if (!args.isEmpty())
+        result[QLatin1String("args")] = args;
+    return result;
+}
+
+struct ReplyTimes
+{
+    qint64 queued;
+    qint64 started;
+    qint64 connecting = -1;
+    qint64 encrypted = -1;
+    qint64 requestSent = -1;
+    qint64 firstByte = -1;
+};
+}
+
+std::atomic<bool> Tracer::s_enabled(false);
+
+void Tracer::startFromEnvironment()
+{
+    const QString fileName = qEnvironmentVariable("SEVENTEENHELPER_TRACE");
+    if (!fileName.isEmpty())
+        start(fileName);
+}
+
+void Tracer::start(const QString &fileName)
+{
+    TraceState &state = traceState();
+    QMutexLocker locker(&state.mutex);
+    s_enabled.store(false);
+    state.fileName = fileName;
+    state.events.clear();
+    state.clock.start();
+    s_enabled.store(true, std::memory_order_release);
+}
+
+bool Tracer::stop()
+{
+    if (!s_enabled.exchange(false))
+        return false;
+    TraceState &state = traceState();
+    QMutexLocker locker(&state.mutex);
+    QJsonArray traceEvents;
+    const QVector<TraceEvent> &events = state.events;
+    for (const TraceEvent &event : events) {
+        if (event.asyncId == 0) {
+            QJsonObject completeEvent = eventObject(event, "X", event.begin);
+            completeEvent[QLatin1String("dur")] = event.end - event.begin;
+            traceEvents.append(completeEvent);
+        } else {
+            traceEvents.append(eventObject(event, "b", event.begin));
+            traceEvents.append(eventObject(event, "e", event.end));
+        }
+    }
+    state.events.clear();
+    QJsonObject traceObject;
+    traceObject[QLatin1String("traceEvents")] = traceEvents;
+    traceObject[QLatin1String("displayTimeUnit")] = QLatin1String("ms");
+    QSaveFile traceFile(state.fileName);
+    if (!traceFile.open(QIODevice::WriteOnly))
+        return false;
+    traceFile.write(QJsonDocument(traceObject).toJson(QJsonDocument::Compact));
+    return traceFile.commit();
+}
+
+qint64 Tracer::now()
+{
+    // the clock is started before tracing is enabled
+    if (!s_enabled.load(std::memory_order_acquire))
+        return -1;
+    return traceState().clock.nsecsElapsed() / 1000;
+}
+
+void Tracer::addSpan(const char *name, const char *category, qint64 begin, qint64 end, const QString &set, int cards)
+{
+    if (!isEnabled())
+        return;
+    appendEvent(TraceEvent{name, category, begin, end, 0, 0, set, QString(), cards});
+}
+
+void Tracer::traceReply(QNetworkReply *reply, qint64 queuedAt)
+{
+    if (!isEnabled())
+        return;
+    QSharedPointer<ReplyTimes> times(new ReplyTimes);
+    times->queued = queuedAt >= 0 ? queuedAt : now();
+    times->started = now();
+    // before Qt 6.3 the connection is not reported and the request counts as sent when it starts
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    QObject::connect(reply, &QNetworkReply::socketStartedConnecting, reply, [times]() { times->connecting = now(); });
+    QObject::connect(reply, &QNetworkReply::requestSent, reply, [times]() { times->requestSent = now(); });
+#endif
+#ifndef QT_NO_SSL
+    QObject::connect(reply, &QNetworkReply::encrypted, reply, [times]() { times->encrypted = now(); });
+#endif
+    QObject::connect(reply, &QNetworkReply::metaDataChanged, reply, [times]() {
+        if (times->firstByte < 0)
+            times->firstByte = now();
+    });
+    QObject::connect(reply, &QNetworkReply::finished, reply, [times, reply]() {
+        if (!isEnabled())
+            return;
+        const qint64 finished = now();
+        // the query can hold credentials, the sign-in one does
+        const QString url = reply->url().toString(QUrl::RemoveScheme | QUrl::RemoveUserInfo | QUrl::RemoveQuery);
+        const QString set = QUrlQuery(reply->url()).queryItemValue(QStringLiteral("expansion"));
+        TraceState &state = traceState();
+        QMutexLocker locker(&state.mutex);
+        const int thread = threadId(state);
+        const quint64 asyncId = state.nextAsyncId++;
+        state.events.append(TraceEvent{"request queued", "network", times->queued, times->started, asyncId, thread, set, url, -1});
+        const qint64 sent = times->requestSent >= 0 ? times->requestSent : times->started;
+        if (times->connecting >= 0) {
+            const qint64 connected = times->encrypted >= 0 ? times->encrypted : sent;
+            state.events.append(TraceEvent{"connect/TLS", "network", times->connecting, connected, asyncId, thread, set, url, -1});
+        }
+        const qint64 firstByte = times->firstByte >= 0 ? times->firstByte : finished;
+        state.events.append(TraceEvent{"time to first byte", "network", sent, firstByte, asyncId, thread, set, url, -1});
+        state.events.append(TraceEvent{"transfer", "network", firstByte, finished, asyncId, thread, set, url, -1});
+    });
+}
+
+TraceSpan::TraceSpan(const char *name, const char *category, const QString &set, int cards)
+    : m_name(name)
+    , m_category(category)
+    , m_cards(cards)
+    , m_begin(-1)
+{
+    if (!Tracer::isEnabled())
+        return;
+    m_set = set;
+    m_begin = Tracer::now();
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (m_begin >= 0)
+        Tracer::addSpan(m_name, m_category, m_begin, Tracer::now(), m_set, m_cards);
+}
+
+void TraceSpan::setCards(int cards)
+{
+    m_cards = cards;
+}
@@ -0,0 +1,57 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef TRACER_H
+#define TRACER_H
+#include <QString>
+#include <atomic>
+class QNetworkReply;
+// Opt-in timing of the pipeline stages, written as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+// While tracing is off a span costs one relaxed atomic load.
+class Tracer
+{
+public:
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    // starts tracing if SEVENTEENHELPER_TRACE names the output file
+    static void startFromEnvironment();
+    static void start(const QString &fileName);
+    // writes the file and stops tracing
+    static bool stop();
+    // microseconds since start(), -1 while tracing is off
+    static qint64 now();
+    static void addSpan(const char *name, const char *category, qint64 begin, qint64 end, const QString &set = QString(), int cards = -1);
+    // records queueing, connection, time to first byte and transfer of the reply as asynchronous spans,
+    // the reply counts as queued now unless queuedAt is given. The query is left out of the recorded url.
+    static void traceReply(QNetworkReply *reply, qint64 queuedAt = -1);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class TraceSpan
+{
+    Q_DISABLE_COPY_MOVE(TraceSpan)
+public:
+    TraceSpan(const char *name, const char *category, const QString &set = QString(), int cards = -1);
+    ~TraceSpan();
+    void setCards(int cards);
+
+private:
+    const char *m_name;
+    const char *m_category;
+    QString m_set;
+    int m_cards;
+    qint64 m_begin;
+};
+#endif
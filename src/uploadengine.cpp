@@ -0,0 +1,169 @@
+#include "uploadengine.h"
+#include "requestscheduler.h"
+#include <QNetworkReply>
+#include <algorithm>
+#include <functional>
+namespace {
+void appendJsonString(QByteArray &buffer, const QString &value)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    const QByteArray utf8 = value.toUtf8();
+    buffer += '"';
+    for (const char byte : utf8) {
+        switch (byte) {
+        case '"':
+            buffer += "\\\"";
+            break;
+        case '\\':
+            buffer += "\\\\";
+            break;
+        case '\n':
+            buffer += "\\n";
+            break;
+        case '\r':
+            buffer += "\\r";
+            break;
+        case '\t':
+            buffer += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(byte) < 0x20) {
+                buffer += "\\u00";
+                buffer += hexDigits[byte >> 4];
+                buffer += hexDigits[byte & 0xf];
+            } else {
+                buffer += byte;
+            }
+        }
+    }
+    buffer += '"';
+}
+}
+
+UploadEngine::UploadEngine(RequestScheduler *scheduler, QObject *parent)
+    : QObject(parent)
+    , m_scheduler(scheduler)
+    , m_batchElapsed(0)
+    , m_nextSetReport(0)
+    , m_window(16)
+    , m_inFlight(0)
+    , m_outstanding(0)
+    , m_batchUploaded(0)
+{
+    Q_ASSERT(m_scheduler);
+}
+
+void UploadEngine::setRequest(const QNetworkRequest &request)
+{
+    m_request = request;
+}
+
+int UploadEngine::window() const
+{
+    return m_window;
+}
+
+void UploadEngine::setWindow(int window)
+{
+    m_window = std::max(1, window);
+    fillWindow();
+}
+
+int UploadEngine::outstanding() const
+{
+    return m_outstanding;
+}
+
+double UploadEngine::cardsPerSecond() const
+{
+    if (!m_batchTimer.isValid())
+        return 0.0;
+    const qint64 elapsed = m_outstanding > 0 ? m_batchTimer.elapsed() : m_batchElapsed;
+    return elapsed > 0 ? m_batchUploaded * 1000.0 / elapsed : 0.0;
+}
+
+void UploadEngine::appendBody(QByteArray &buffer, const MtgahCard &card)
+{
+    buffer += "{\"idArena\":";
+    buffer += QByteArray::number(card.id_arena);
+    buffer += ",\"note\":";
+    if (card.note.isEmpty())
+        buffer += "null";
+    else
+        appendJsonString(buffer, card.note);
+    buffer += ",\"rating\":";
+    if (card.rating < 0)
+        buffer += "null";
+    else
+        buffer += QByteArray::number(int(card.rating));
+    buffer += '}';
+}
+
+void UploadEngine::enqueue(const QVector<MtgahCard> &cards)
+{
+    if (cards.isEmpty())
+        return;
+    if (m_outstanding == 0) {
+        m_batchTimer.start();
+        m_batchUploaded = 0;
+    }
+    for (const MtgahCard &card : cards) {
+        auto setIter = m_setIndexes.find(card.set);
+        // a set already reported as completed starts over at the back
+        if (setIter == m_setIndexes.end() || setIter.value() < m_nextSetReport) {
+            m_sets.append(SetProgress{card.set, 0, 0, 0});
+            setIter = m_setIndexes.insert(card.set, m_sets.size() - 1);
+        }
+        ++m_sets[setIter.value()].remaining;
+        m_bodyBuffer.resize(0);
+        appendBody(m_bodyBuffer, card);
+        m_queue.append(Upload{card, QByteArray(m_bodyBuffer.constData(), m_bodyBuffer.size()), setIter.value()});
+    }
+    m_outstanding += cards.size();
+    fillWindow();
+}
+
+void UploadEngine::fillWindow()
+{
+    while (m_inFlight < m_window && !m_queue.isEmpty()) {
+        const Upload upload = m_queue.takeFirst();
+        ++m_inFlight;
+        m_scheduler->put(m_request, upload.body, RequestScheduler::ReplyHandler(),
+                         std::bind(&UploadEngine::onReplyFinished, this, upload, std::placeholders::_1));
+    }
+}
+
+void UploadEngine::onReplyFinished(const Upload &upload, QNetworkReply *reply)
+{
+    --m_inFlight;
+    completeUpload(upload,
+                   reply->error() == QNetworkReply::NoError && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200);
+    fillWindow();
+    if (m_outstanding == 0) {
+        m_batchElapsed = m_batchTimer.elapsed();
+        m_sets.clear();
+        m_setIndexes.clear();
+        m_nextSetReport = 0;
+        emit finished();
+    }
+}
+
+void UploadEngine::completeUpload(const Upload &upload, bool succeeded)
+{
+    --m_outstanding;
+    SetProgress &setProgress = m_sets[upload.setIndex];
+    --setProgress.remaining;
+    if (succeeded) {
+        ++m_batchUploaded;
+        ++setProgress.uploaded;
+        emit cardUploaded(upload.card);
+    } else {
+        ++setProgress.failed;
+        emit cardFailed(upload.card);
+    }
+    emit progress(m_outstanding);
+    for (; m_nextSetReport < m_sets.size() && m_sets.at(m_nextSetReport).remaining == 0; ++m_nextSetReport) {
+        const SetProgress &completed = m_sets.at(m_nextSetReport);
+        emit setCompleted(completed.set, completed.uploaded, completed.failed);
+    }
+}
@@ -0,0 +1,83 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef UPLOADENGINE_H
+#define UPLOADENGINE_H
+#include "mtgahcard.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QVector>
+class RequestScheduler;
+class QNetworkReply;
+// Feeds the rating PUTs to the scheduler keeping at most window() of them in flight. Bodies are
+// serialized when the cards are enqueued and setCompleted is emitted in the order the sets were enqueued.
+// Transient failures are retried by the scheduler according to the policy of the host, not here.
+class UploadEngine : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(UploadEngine)
+public:
+    explicit UploadEngine(RequestScheduler *scheduler, QObject *parent = nullptr);
+    void setRequest(const QNetworkRequest &request);
+    int window() const;
+    void setWindow(int window);
+    void enqueue(const QVector<MtgahCard> &cards);
+    // cards enqueued and not completed yet
+    int outstanding() const;
+    // cards accepted by the server per second since the current batch started
+    double cardsPerSecond() const;
+    static void appendBody(QByteArray &buffer, const MtgahCard &card);
+signals:
+    void cardUploaded(const MtgahCard &card);
+    void cardFailed(const MtgahCard &card);
+    void setCompleted(const QString &set, int uploaded, int failed);
+    void progress(int outstanding);
+    void finished();
+
+private:
+    struct Upload
+    {
+        MtgahCard card;
+        QByteArray body;
+        int setIndex;
+    };
+    struct SetProgress
+    {
+        QString set;
+        int remaining;
+        int uploaded;
+        int failed;
+    };
+    void fillWindow();
+    void onReplyFinished(const Upload &upload, QNetworkReply *reply);
+    void completeUpload(const Upload &upload, bool succeeded);
+    RequestScheduler *m_scheduler;
+    QNetworkRequest m_request;
+    QList<Upload> m_queue;
+    QVector<SetProgress> m_sets;
+    QHash<QString, int> m_setIndexes;
+    QByteArray m_bodyBuffer;
+    QElapsedTimer m_batchTimer;
+    qint64 m_batchElapsed;
+    int m_nextSetReport;
+    int m_window;
+    int m_inFlight;
+    int m_outstanding;
+    int m_batchUploaded;
+};
+
+#endif
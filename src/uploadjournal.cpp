@@ -0,0 +1,167 @@
+#include "uploadjournal.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+namespace {
+const char pendingOperation = 'P';
+const char acknowledgedOperation = 'A';
+
+bool sameUpload(const MtgahCard &a, const MtgahCard &b)
+{
+    return a.id_arena == b.id_arena && a.rating == b.rating && a.note == b.note;
+}
+}
+
+UploadJournal::UploadJournal(const QString &directory)
+    : m_directory(directory)
+    , m_records(0)
+    , m_compactionThreshold(1024)
+{
+    if (m_directory.isEmpty())
+        m_directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QLatin1String("/uploads");
+}
+
+bool UploadJournal::open(const QString &account)
+{
+    close();
+    QDir().mkpath(m_directory);
+    const QByteArray accountHash = QCryptographicHash::hash(account.trimmed().toLower().toUtf8(), QCryptographicHash::Sha1).toHex();
+    m_file.setFileName(m_directory + QLatin1Char('/') + QString::fromLatin1(accountHash) + QLatin1String(".journal"));
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Append))
+        return false;
+    replay();
+    return true;
+}
+
+void UploadJournal::close()
+{
+    if (m_file.isOpen())
+        m_file.close();
+    m_pending.clear();
+    m_records = 0;
+}
+
+bool UploadJournal::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+QVector<MtgahCard> UploadJournal::pending() const
+{
+    QVector<MtgahCard> result;
+    result.reserve(m_pending.size());
+    for (auto i = m_pending.cbegin(), iEnd = m_pending.cend(); i != iEnd; ++i)
+        result.append(i.value());
+    return result;
+}
+
+int UploadJournal::pendingCount() const
+{
+    return m_pending.size();
+}
+
+void UploadJournal::addPending(const QVector<MtgahCard> &cards)
+{
+    if (!m_file.isOpen())
+        return;
+    QByteArray records;
+    for (const MtgahCard &card : cards) {
+        const auto pendingIter = m_pending.constFind(card.id_arena);
+        if (pendingIter != m_pending.constEnd() && sameUpload(pendingIter.value(), card))
+            continue;
+        m_pending.insert(card.id_arena, card);
+        records += record(pendingOperation, card);
+        ++m_records;
+    }
+    if (records.isEmpty())
+        return;
+    m_file.write(records);
+    m_file.flush();
+}
+
+void UploadJournal::acknowledge(const MtgahCard &card)
+{
+    if (!m_file.isOpen())
+        return;
+    const auto pendingIter = m_pending.find(card.id_arena);
+    // a newer upload of the same card is still pending
+    if (pendingIter == m_pending.end() || !sameUpload(pendingIter.value(), card))
+        return;
+    m_pending.erase(pendingIter);
+    m_file.write(record(acknowledgedOperation, card));
+    m_file.flush();
+    if (++m_records >= m_compactionThreshold && m_records > 2 * m_pending.size())
+        compact();
+}
+
+void UploadJournal::setCompactionThreshold(int records)
+{
+    m_compactionThreshold = records;
+}
+
+QByteArray UploadJournal::record(char operation, const MtgahCard &card)
+{
+    QJsonObject recordObject;
+    recordObject[QLatin1String("op")] = QString(QLatin1Char(operation));
+    recordObject[QLatin1String("id")] = card.id_arena;
+    recordObject[QLatin1String("rating")] = card.rating;
+    recordObject[QLatin1String("note")] = card.note;
+    if (operation == pendingOperation) {
+        recordObject[QLatin1String("name")] = card.name;
+        recordObject[QLatin1String("set")] = card.set;
+    }
+    return QJsonDocument(recordObject).toJson(QJsonDocument::Compact) + '\n';
+}
+
+void UploadJournal::replay()
+{
+    m_file.seek(0);
+    bool truncated = false;
+    while (!m_file.atEnd()) {
+        const QByteArray line = m_file.readLine();
+        // a line without terminator was cut by a crash while being written
+        if (!line.endsWith('\n')) {
+            truncated = true;
+            break;
+        }
+        const QJsonObject recordObject = QJsonDocument::fromJson(line).object();
+        const QString operation = recordObject[QLatin1String("op")].toString();
+        if (operation.isEmpty())
+            continue;
+        ++m_records;
+        MtgahCard card;
+        card.id_arena = recordObject[QLatin1String("id")].toInt();
+        card.rating = static_cast<char>(recordObject[QLatin1String("rating")].toInt(-1));
+        card.note = recordObject[QLatin1String("note")].toString();
+        if (operation.at(0) == QLatin1Char(pendingOperation)) {
+            card.setName(recordObject[QLatin1String("name")].toString());
+            card.setSet(recordObject[QLatin1String("set")].toString());
+            m_pending.insert(card.id_arena, card);
+        } else {
+            const auto pendingIter = m_pending.find(card.id_arena);
+            if (pendingIter != m_pending.end() && sameUpload(pendingIter.value(), card))
+                m_pending.erase(pendingIter);
+        }
+    }
+    if (truncated || (m_records > 0 && m_records > 2 * m_pending.size()))
+        compact();
+}
+
+void UploadJournal::compact()
+{
+    QSaveFile compacted(m_file.fileName());
+    if (!compacted.open(QIODevice::WriteOnly))
+        return;
+    for (auto i = m_pending.cbegin(), iEnd = m_pending.cend(); i != iEnd; ++i)
+        compacted.write(record(pendingOperation, i.value()));
+    m_file.close();
+    if (!compacted.commit()) {
+        m_file.open(QIODevice::ReadWrite | QIODevice::Append);
+        return;
+    }
+    m_records = m_pending.size();
+    m_file.open(QIODevice::ReadWrite | QIODevice::Append);
+}
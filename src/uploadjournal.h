@@ -0,0 +1,52 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef UPLOADJOURNAL_H
+#define UPLOADJOURNAL_H
+#include "mtgahcard.h"
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+// Append-only log of the rating uploads of one account. Every upload is written as pending before
+// it is sent and as acknowledged once the server accepted it, so after a crash, logout or network
+// failure pending() is exactly what still has to be sent. The file is rewritten with only the
+// pending uploads once acknowledged records dominate it.
+class UploadJournal
+{
+    Q_DISABLE_COPY_MOVE(UploadJournal)
+public:
+    explicit UploadJournal(const QString &directory = QString());
+    // opens the journal of the account, replaying what was left on disk
+    bool open(const QString &account);
+    void close();
+    bool isOpen() const;
+    QVector<MtgahCard> pending() const;
+    int pendingCount() const;
+    void addPending(const QVector<MtgahCard> &cards);
+    void acknowledge(const MtgahCard &card);
+    void setCompactionThreshold(int records);
+
+private:
+    static QByteArray record(char operation, const MtgahCard &card);
+    void replay();
+    void compact();
+    QString m_directory;
+    QFile m_file;
+    QHash<int, MtgahCard> m_pending;
+    int m_records;
+    int m_compactionThreshold;
+};
+
+#endif
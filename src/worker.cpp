@@ -1,31 +1,79 @@
 #include "worker.h"
-#include <QCoreApplication>
+#include "seventeenlandsparser.h"
+#include "tracer.h"
+#include "uploadengine.h"
+#include <QCryptographicHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
-#include <QTimer>
-#ifdef QT_DEBUG
-#    include <QDebug>
-#endif
+#include <QSharedPointer>
+#include <algorithm>
 Worker::Worker(QObject *parent)
     : QObject(parent)
     , m_nam(new QNetworkAccessManager(this))
+    , m_cookieJar(new SessionCookieJar(m_nam))
+    , m_scheduler(new RequestScheduler(m_nam, this))
+    , m_connectionStats(new ConnectionStats(m_nam, this))
+    , m_uploadEngine(new UploadEngine(m_scheduler, this))
+    , m_requestFactory(Endpoints::fromEnvironment())
+    , m_snapshotEnabled(false)
+    , m_restoredSession(false)
     , m_SLrequestOutstanding(0)
-    , m_MTGAHrequestOutstanding(0)
+    , m_cubeRequestOutstanding(0)
 {
-    QTimer *requestTimer = new QTimer(this);
-    requestTimer->setInterval(100);
-    connect(requestTimer, &QTimer::timeout, this, &Worker::processSLrequestQueue);
-    connect(requestTimer, &QTimer::timeout, this, &Worker::processMTGAHrequestQueue);
-    requestTimer->start();
+    m_nam->setCookieJar(m_cookieJar);
+    connect(m_scheduler, &RequestScheduler::replyStarted, m_connectionStats, &ConnectionStats::track);
+    connect(m_uploadEngine, &UploadEngine::cardUploaded, this, [this](const MtgahCard &card) {
+        m_uploadJournal.acknowledge(card);
+        emit ratingUploaded(card);
+    });
+    // stays pending in the journal and is sent again by the next upload
+    connect(m_uploadEngine, &UploadEngine::cardFailed, this, &Worker::failedUploadRating);
+    connect(m_uploadEngine, &UploadEngine::setCompleted, this, &Worker::setRatingsUploaded);
+    connect(m_uploadEngine, &UploadEngine::progress, this, &Worker::ratingsUploadProgress);
+    connect(m_uploadEngine, &UploadEngine::finished, this, [this]() {
+        emit ratingsUploadRate(m_uploadEngine->cardsPerSecond());
+        emit allRatingsUploaded();
+    });
+    applyDefaultPolicies();
 }
 
-QMultiHash<QString, MtgahCard> *Worker::ratingsTemplate()
+void Worker::applyDefaultPolicies()
 {
-    return &m_ratingsTemplate;
+    RequestScheduler::HostPolicy slPolicy;
+    slPolicy.maxInFlight = 4;
+    slPolicy.requestsPerSecond = 5.0;
+    slPolicy.burst = 4.0;
+    m_scheduler->setHostPolicy(m_requestFactory.endpoints().baseUrl(Endpoints::SeventeenLands).host(), slPolicy);
+    RequestScheduler::HostPolicy mtgahPolicy;
+    mtgahPolicy.maxInFlight = m_uploadEngine->window();
+    mtgahPolicy.requestsPerSecond = 20.0;
+    mtgahPolicy.burst = m_uploadEngine->window();
+    m_scheduler->setHostPolicy(m_requestFactory.endpoints().baseUrl(Endpoints::MtgaHelper).host(), mtgahPolicy);
+}
+
+void Worker::setEndpoints(const Endpoints &endpoints)
+{
+    m_requestFactory.setEndpoints(endpoints);
+    applyDefaultPolicies();
+}
+
+void Worker::prewarmConnections()
+{
+    m_requestFactory.prewarm(m_nam);
+}
+
+const ConnectionStatsMap &Worker::connectionStats() const
+{
+    return m_connectionStats->stats();
+}
+
+void Worker::setRequestPolicy(const QString &host, const RequestScheduler::HostPolicy &policy)
+{
+    m_scheduler->setHostPolicy(host, policy);
 }
 
 void Worker::tryLogin(const QString &userName, const QString &password)
@@ -34,12 +82,13 @@ void Worker::tryLogin(const QString &userName, const QString &password)
         emit loginFalied();
         return;
     }
-    const QUrl loginUrl = QUrl::fromUserInput(QStringLiteral("https://mtgahelper.com/api/Account/Signin?email=") + userName
-                                              + QStringLiteral("&password=") + password);
-    QNetworkReply *reply = m_nam->get(QNetworkRequest(loginUrl));
+    const QString loginPath = QStringLiteral("/api/Account/Signin?email=") + userName + QStringLiteral("&password=") + password;
+    QNetworkReply *reply = m_nam->get(m_requestFactory.request(Endpoints::MtgaHelper, loginPath));
+    Tracer::traceReply(reply);
+    m_connectionStats->track(reply);
     connect(reply, &QNetworkReply::errorOccurred, this, &Worker::loginFalied);
     connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
-    connect(reply, &QNetworkReply::finished, this, [reply, this]() -> void {
+    connect(reply, &QNetworkReply::finished, this, [reply, userName, this]() -> void {
         if (reply->error() != QNetworkReply::NoError)
             return;
         if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
@@ -57,14 +106,83 @@ void Worker::tryLogin(const QString &userName, const QString &password)
             emit loginFalied();
             return;
         }
+        m_userName = userName;
+        m_restoredSession = false;
+        if (m_snapshotEnabled) {
+            m_snapshot.setSession(userName, m_cookieJar->cookies());
+            saveSnapshot();
+        }
         emit loggedIn();
+        if (m_uploadJournal.open(userName) && m_uploadJournal.pendingCount() > 0)
+            emit pendingUploadsFound(m_uploadJournal.pendingCount());
     });
 }
 
+void Worker::loadSnapshot()
+{
+    TraceSpan loadSpan("snapshot load", "cpu");
+    m_snapshotEnabled = true;
+    m_snapshot.load();
+    // names of sets rarely change, Scryfall is asked only when some set has none
+    if (m_snapshot.setNames().isEmpty())
+        downloadSetsScryfall();
+    else
+        emit setsScryfall(m_snapshot.setNames());
+    if (!m_snapshot.sets().isEmpty())
+        emit setsMTGAH(m_snapshot.sets());
+    if (m_snapshot.account().isEmpty() || m_snapshot.cookies().isEmpty())
+        return;
+    m_cookieJar->setCookies(m_snapshot.cookies());
+    m_userName = m_snapshot.account();
+    m_restoredSession = true;
+    emit sessionRestored(m_userName);
+    // uploads can start before the session is confirmed, they must be journaled from the start
+    if (m_uploadJournal.open(m_userName) && m_uploadJournal.pendingCount() > 0)
+        emit pendingUploadsFound(m_uploadJournal.pendingCount());
+    if (m_snapshot.ratingsTemplate().isEmpty())
+        return;
+    m_templateHash = m_snapshot.templateHash();
+    loadSpan.setCards(m_snapshot.ratingsTemplate().size());
+    emit customRatingTemplate(m_snapshot.ratingsTemplate());
+}
+
+void Worker::confirmSession()
+{
+    m_restoredSession = false;
+}
+
+void Worker::expireSession()
+{
+    m_uploadJournal.close();
+    m_restoredSession = false;
+    m_userName.clear();
+    m_templateHash.clear();
+    m_cookieJar->clear();
+    m_snapshot.clearSession();
+    saveSnapshot();
+    emit sessionExpired();
+}
+
+void Worker::saveSnapshot()
+{
+    if (!m_snapshotEnabled)
+        return;
+    TraceSpan saveSpan("snapshot save", "cpu");
+    m_snapshot.save();
+}
+
 void Worker::logOut()
 {
-    const QUrl setsUrl = QUrl::fromUserInput(QStringLiteral("https://mtgahelper.com/api/Account/Signout"));
-    QNetworkReply *reply = m_nam->post(QNetworkRequest(setsUrl), QByteArray());
+    m_uploadJournal.close();
+    m_userName.clear();
+    m_templateHash.clear();
+    m_restoredSession = false;
+    if (m_snapshotEnabled) {
+        m_snapshot.clearSession();
+        saveSnapshot();
+    }
+    QNetworkReply *reply = m_nam->post(m_requestFactory.request(Endpoints::MtgaHelper, QStringLiteral("/api/Account/Signout")), QByteArray());
+    m_connectionStats->track(reply);
     connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
     connect(reply, &QNetworkReply::errorOccurred, this, &Worker::logoutFailed);
     connect(reply, &QNetworkReply::finished, this, [reply, this]() -> void {
@@ -80,8 +198,9 @@ void Worker::logOut()
 
 void Worker::downloadSetsMTGAH()
 {
-    const QUrl setsUrl = QUrl::fromUserInput(QStringLiteral("https://mtgahelper.com/api/Misc/Sets"));
-    QNetworkReply *reply = m_nam->get(QNetworkRequest(setsUrl));
+    QNetworkReply *reply = m_nam->get(m_requestFactory.request(Endpoints::MtgaHelper, QStringLiteral("/api/Misc/Sets")));
+    Tracer::traceReply(reply);
+    m_connectionStats->track(reply);
     connect(reply, &QNetworkReply::errorOccurred, this, &Worker::downloadSetsMTGAHFailed);
     connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
     connect(reply, &QNetworkReply::finished, this, [reply, this]() -> void {
@@ -105,22 +224,28 @@ void Worker::downloadSetsMTGAH()
         }
         QJsonArray setsArray = setsArrVal.toArray();
         QStringList setList;
+        QSet<QString> knownSets;
         for (auto i = setsArray.cbegin(), iEnd = setsArray.cend(); i != iEnd; ++i) {
             const QString setStr = i->toObject()[QLatin1String("name")].toString().toUpper();
-            if (!setStr.isEmpty())
-                setList.append(setStr.toUpper());
+            if (setStr.isEmpty() || knownSets.contains(setStr))
+                continue;
+            knownSets.insert(setStr);
+            setList.append(setStr);
         }
         if (setList.isEmpty()) {
             emit downloadSetsMTGAHFailed();
             return;
         }
-        for (auto i = setList.begin(); i != setList.end(); ++i) {
-            for (auto j = i + 1; j != setList.end();) {
-                if (*i == *j)
-                    j = setList.erase(j);
-                else
-                    ++j;
+        if (m_snapshotEnabled) {
+            if (setList != m_snapshot.sets()) {
+                m_snapshot.setSets(setList);
+                saveSnapshot();
             }
+            // a set released since the names were saved, the names are empty only if Scryfall was already asked
+            const QHash<QString, QString> &setNames = m_snapshot.setNames();
+            if (!setNames.isEmpty()
+                && std::any_of(setList.cbegin(), setList.cend(), [&setNames](const QString &set) { return !setNames.contains(set); }))
+                downloadSetsScryfall();
         }
         emit setsMTGAH(setList);
     });
@@ -128,8 +253,9 @@ void Worker::downloadSetsMTGAH()
 
 void Worker::downloadSetsScryfall()
 {
-    const QUrl setsUrl = QUrl::fromUserInput(QStringLiteral("https://api.scryfall.com/sets"));
-    QNetworkReply *reply = m_nam->get(QNetworkRequest(setsUrl));
+    QNetworkReply *reply = m_nam->get(m_requestFactory.request(Endpoints::Scryfall, QStringLiteral("/sets")));
+    Tracer::traceReply(reply);
+    m_connectionStats->track(reply);
     connect(reply, &QNetworkReply::errorOccurred, this, &Worker::downloadSetsScryfallFailed);
     connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
     connect(reply, &QNetworkReply::finished, this, [reply, this]() -> void {
@@ -165,68 +291,50 @@ void Worker::downloadSetsScryfall()
             emit downloadSetsScryfallFailed();
             return;
         }
+        if (m_snapshotEnabled) {
+            m_snapshot.setSetNames(setNames);
+            saveSnapshot();
+        }
         emit setsScryfall(setNames);
     });
 }
 
 void Worker::getCustomRatingTemplate()
 {
-    const QUrl setsUrl = QUrl::fromUserInput(QStringLiteral("https://mtgahelper.com/api/User/customDraftRatingsForDisplay"));
-    QNetworkReply *reply = m_nam->get(QNetworkRequest(setsUrl));
-    connect(reply, &QNetworkReply::errorOccurred, this, &Worker::customRatingTemplateFailed);
+    QNetworkReply *reply = m_nam->get(m_requestFactory.request(Endpoints::MtgaHelper, QStringLiteral("/api/User/customDraftRatingsForDisplay")));
+    Tracer::traceReply(reply);
+    m_connectionStats->track(reply);
     connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
     connect(reply, &QNetworkReply::finished, this, [reply, this]() -> void {
-        if (reply->error() != QNetworkReply::NoError)
-            return;
-        if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
-            emit customRatingTemplateFailed();
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        // the server no longer accepts the session saved in the snapshot
+        if (m_restoredSession && (status == 401 || status == 403)) {
+            expireSession();
             return;
         }
-        QJsonParseError parseErr;
-        const QJsonDocument ratingsDocument = QJsonDocument::fromJson(reply->readAll(), &parseErr);
-        if (parseErr.error != QJsonParseError::NoError || !ratingsDocument.isArray()) {
+        if (reply->error() != QNetworkReply::NoError || status != 200) {
             emit customRatingTemplateFailed();
             return;
         }
-        decltype(m_ratingsTemplate) rtgsTemplate;
-        const QJsonArray ratingsArray = ratingsDocument.array();
-        for (auto i = ratingsArray.cbegin(), iEnd = ratingsArray.cend(); i != iEnd; ++i) {
-            QCoreApplication::processEvents();
-            if (!i->isObject())
-                continue;
-            const QJsonObject ratingObject = i->toObject();
-            const QJsonObject cardObject = ratingObject[QLatin1String("card")].toObject();
-            if (cardObject.isEmpty())
-                continue;
-            const int idArenaVal = cardObject[QLatin1String("idArena")].toInt();
-            if (std::find_if(rtgsTemplate.cbegin(), rtgsTemplate.cend(),
-                             [idArenaVal](const MtgahCard &card) -> bool { return idArenaVal == card.id_arena; })
-                != rtgsTemplate.cend())
-                continue;
-            const QString setStr = cardObject[QLatin1String("set")].toString().trimmed().toUpper();
-            if (setStr.isEmpty())
-                continue;
-            const QString nameStr = cardObject[QLatin1String("name")].toString();
-            if (nameStr.isEmpty())
-                continue;
-            MtgahCard card;
-            card.name = nameStr;
-            card.id_arena = idArenaVal;
-            card.set = setStr;
-            const QJsonValue noteValue = ratingObject[QLatin1String("note")];
-            if (!noteValue.isNull())
-                card.note = noteValue.toString();
-            const QJsonValue ratingValue = ratingObject[QLatin1String("rating")];
-            if (!ratingValue.isNull())
-                card.rating = ratingValue.toInt();
-            rtgsTemplate.insert(setStr, card);
+        confirmSession();
+        const QByteArray templateJson = reply->readAll();
+        const QByteArray templateHash = QCryptographicHash::hash(templateJson, QCryptographicHash::Sha1);
+        if (templateHash == m_templateHash) {
+            emit customRatingTemplateUnchanged();
+            return;
         }
+        const RatingsStore rtgsTemplate = RatingsStore::fromMtgahTemplate(templateJson);
         if (rtgsTemplate.isEmpty()) {
             emit customRatingTemplateFailed();
             return;
         }
-        m_ratingsTemplate = rtgsTemplate;
-        emit customRatingTemplate(m_ratingsTemplate);
+        m_templateHash = templateHash;
+        if (m_snapshotEnabled) {
+            m_snapshot.setSession(m_userName, m_cookieJar->cookies());
+            m_snapshot.setRatingsTemplate(rtgsTemplate, templateHash);
+            saveSnapshot();
+        }
+        emit customRatingTemplate(rtgsTemplate);
     });
 }
 
@@ -236,128 +344,164 @@ void Worker::get17LRatings(const QStringList &sets, const QString &format)
         emit failed17LRatings();
         return;
     }
-    m_SLrequestQueue.clear();
+    m_SLrequestOutstanding += sets.size();
     for (const QString &set : sets) {
-        const QUrl ratingsUrl = QUrl::fromUserInput(QStringLiteral("https://www.17lands.com/card_ratings/data?expansion=") + set
-                                                    + QLatin1String("&format=") + format);
-        m_SLrequestQueue.append(std::make_pair(set, QNetworkRequest(ratingsUrl)));
+        fetch17LRatings(set, format, QString(), std::bind(&Worker::on17LRatingsDownloaded, this, set, std::placeholders::_1),
+                        std::bind(&Worker::on17LRatingsFailed, this));
     }
 }
 
-void Worker::processSLrequestQueue()
+void Worker::get17LCube(const QStringList &sets, const QStringList &formats, const QStringList &colorFilters)
 {
-    if (m_SLrequestQueue.isEmpty())
+    if (sets.isEmpty() || formats.isEmpty() || colorFilters.isEmpty()) {
+        emit downloadedAll17LCube();
         return;
-    const std::pair<QString, QNetworkRequest> currReq = m_SLrequestQueue.takeFirst();
-    const QString currSet = currReq.first;
-    ++m_SLrequestOutstanding;
-    QNetworkReply *reply = m_nam->get(currReq.second);
-    connect(reply, &QNetworkReply::errorOccurred, this, &Worker::failed17LRatings);
-    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
-    connect(reply, &QNetworkReply::finished, this, [reply, this, currSet]() -> void {
-        --m_SLrequestOutstanding;
-        if (reply->error() != QNetworkReply::NoError)
-            return;
-        if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
-            emit failed17LRatings();
-            return;
-        }
-        QJsonParseError parseErr;
-        const QJsonDocument ratingsDocument = QJsonDocument::fromJson(reply->readAll(), &parseErr);
-        if (parseErr.error != QJsonParseError::NoError || !ratingsDocument.isArray()) {
-            emit failed17LRatings();
-            return;
-        }
-        QSet<SeventeenCard> rtgsList;
-        const QJsonArray ratingsArray = ratingsDocument.array();
-        for (auto i = ratingsArray.cbegin(), iEnd = ratingsArray.cend(); i != iEnd; ++i) {
-            QCoreApplication::processEvents();
-            if (!i->isObject())
-                continue;
-            const QJsonObject ratingObject = i->toObject();
-            const QString nameStr = ratingObject[QLatin1String("name")].toString();
-            if (nameStr.isEmpty())
-                continue;
-            SeventeenCard card;
-            card.name = nameStr;
-            card.seen_count = ratingObject[QLatin1String("seen_count")].toInt();
-            card.avg_seen = ratingObject[QLatin1String("avg_seen")].toDouble();
-            card.pick_count = ratingObject[QLatin1String("pick_count")].toInt();
-            card.avg_pick = ratingObject[QLatin1String("avg_pick")].toDouble();
-            card.game_count = ratingObject[QLatin1String("game_count")].toInt();
-            card.win_rate = ratingObject[QLatin1String("win_rate")].toDouble();
-            card.opening_hand_game_count = ratingObject[QLatin1String("opening_hand_game_count")].toInt();
-            card.opening_hand_win_rate = ratingObject[QLatin1String("opening_hand_win_rate")].toDouble();
-            card.drawn_game_count = ratingObject[QLatin1String("drawn_game_count")].toInt();
-            card.drawn_win_rate = ratingObject[QLatin1String("drawn_win_rate")].toDouble();
-            card.ever_drawn_game_count = ratingObject[QLatin1String("ever_drawn_game_count")].toInt();
-            card.ever_drawn_win_rate = ratingObject[QLatin1String("ever_drawn_win_rate")].toDouble();
-            card.never_drawn_game_count = ratingObject[QLatin1String("never_drawn_game_count")].toInt();
-            card.never_drawn_win_rate = ratingObject[QLatin1String("never_drawn_win_rate")].toDouble();
-            card.drawn_improvement_win_rate = ratingObject[QLatin1String("drawn_improvement_win_rate")].toDouble();
-            rtgsList.insert(card);
-        }
-        if (rtgsList.isEmpty()) {
-            emit failed17LRatings();
-            return;
+    }
+    m_cubeRequestOutstanding += sets.size() * formats.size() * colorFilters.size();
+    emit download17LCubeProgress(m_cubeRequestOutstanding);
+    for (const QString &set : sets) {
+        for (const QString &format : formats) {
+            for (const QString &colors : colorFilters) {
+                fetch17LRatings(
+                        set, format, colors,
+                        [this, set, format, colors](const SeventeenTable &ratings) -> void {
+                            emit downloaded17LSlice(set, format, colors, ratings);
+                            on17LSliceCompleted();
+                        },
+                        [this, set, format, colors]() -> void {
+                            emit failed17LSlice(set, format, colors);
+                            on17LSliceCompleted();
+                        });
+            }
         }
-        emit downloaded17LRatings(currSet, rtgsList);
-        if (m_SLrequestQueue.size() + m_SLrequestOutstanding == 0)
-            emit downloadedAll17LRatings();
-        emit download17LRatingsProgress(m_SLrequestQueue.size() + m_SLrequestOutstanding);
-    });
+    }
 }
 
-void Worker::uploadRatings(const QStringList &sets)
+void Worker::on17LSliceCompleted()
 {
-    for (const QString &set : sets) {
-        auto cardsRange = qAsConst(m_ratingsTemplate).equal_range(set);
-        if (cardsRange.first == m_ratingsTemplate.cend())
-            continue;
-        for (auto i = cardsRange.first; i != cardsRange.second; ++i) {
-            const QUrl ratingUrl = QUrl::fromUserInput(QStringLiteral("https://mtgahelper.com/api/User/CustomDraftRating"));
-            QNetworkRequest ratingReq(ratingUrl);
-            ratingReq.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
-            m_MTGAHrequestQueue.append(std::make_pair(*i, ratingReq));
-        }
-    }
-    emit ratingsUploadMaxProgress(m_MTGAHrequestQueue.size());
+    --m_cubeRequestOutstanding;
+    emit download17LCubeProgress(m_cubeRequestOutstanding);
+    if (m_cubeRequestOutstanding == 0)
+        emit downloadedAll17LCube();
 }
 
-void Worker::processMTGAHrequestQueue()
+void Worker::fetch17LRatings(const QString &set, const QString &format, const QString &colors, const RatingsHandler &onDownloaded,
+                             const std::function<void()> &onFailed)
 {
-    if (m_MTGAHrequestQueue.isEmpty())
+    QString cacheKey = SeventeenLandsCache::key(set, format, colors);
+    // keep data served by a redirected endpoint apart from the real one
+    if (m_requestFactory.endpoints().baseUrl(Endpoints::SeventeenLands) != Endpoints::defaultBaseUrl(Endpoints::SeventeenLands))
+        cacheKey.prepend(m_requestFactory.endpoints().baseUrl(Endpoints::SeventeenLands).toString() + QLatin1Char('/'));
+    SeventeenLandsCache::Entry cached;
+    const bool isCached = m_ratingsCache.lookup(cacheKey, cached);
+    if (isCached && cached.fresh) {
+        onDownloaded(cached.ratings);
         return;
-    const std::pair<MtgahCard, QNetworkRequest> currReq = m_MTGAHrequestQueue.takeFirst();
-    const MtgahCard currCard = currReq.first;
-    QJsonObject cardData;
-    cardData[QLatin1String("idArena")] = currCard.id_arena;
-    if (currCard.note.isEmpty())
-        cardData[QLatin1String("note")] = QJsonValue();
-    else
-        cardData[QLatin1String("note")] = currCard.note;
-    if (currCard.rating < 0)
-        cardData[QLatin1String("rating")] = QJsonValue();
-    else
-        cardData[QLatin1String("rating")] = currCard.rating;
-    ++m_MTGAHrequestOutstanding;
-    QNetworkReply *reply = m_nam->put(currReq.second, QJsonDocument(cardData).toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::errorOccurred, this, std::bind(&Worker::failedUploadRating, this, currCard));
-    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
-    connect(reply, &QNetworkReply::finished, this, [reply, this, currCard]() -> void {
-        --m_MTGAHrequestOutstanding;
-        if (reply->error() != QNetworkReply::NoError){
-            qDebug() << QStringLiteral("Failed: ") << currCard.name;
-            return;
-        }
-        if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
-            qDebug() << QStringLiteral("Failed: ") << currCard.name;
-            emit failedUploadRating(currCard);
-            return;
+    }
+    QString query = QStringLiteral("/card_ratings/data?expansion=") + set + QLatin1String("&format=") + format;
+    if (!colors.isEmpty())
+        query += QLatin1String("&colors=") + colors;
+    QNetworkRequest ratingsRequest = m_requestFactory.request(Endpoints::SeventeenLands, query);
+    if (isCached) {
+        if (!cached.etag.isEmpty())
+            ratingsRequest.setRawHeader(QByteArrayLiteral("If-None-Match"), cached.etag);
+        if (!cached.lastModified.isEmpty())
+            ratingsRequest.setRawHeader(QByteArrayLiteral("If-Modified-Since"), cached.lastModified);
+    }
+    QSharedPointer<SeventeenTable> rtgsList(new SeventeenTable);
+    QSharedPointer<SeventeenLandsParser> parser(new SeventeenLandsParser([rtgsList](const SeventeenCard &card) { rtgsList->append(card); }));
+    m_scheduler->get(
+            ratingsRequest,
+            [this, set, parser, rtgsList](QNetworkReply *reply) -> void {
+                parser->reset();
+                rtgsList->clear();
+                connect(reply, &QNetworkReply::readyRead, this, [reply, set, parser]() -> void {
+                    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
+                        TraceSpan parseSpan("JSON parse", "cpu", set);
+                        parser->addData(reply->readAll());
+                    }
+                });
+            },
+            [this, cacheKey, cached, parser, rtgsList, onDownloaded, onFailed](QNetworkReply *reply) -> void {
+                if (reply->error() != QNetworkReply::NoError) {
+                    onFailed();
+                    return;
+                }
+                const QByteArray etag = reply->rawHeader(QByteArrayLiteral("ETag"));
+                const QByteArray lastModified = reply->rawHeader(QByteArrayLiteral("Last-Modified"));
+                const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                if (statusCode == 304 && !cached.ratings.isEmpty()) {
+                    m_ratingsCache.markRevalidated(cacheKey, etag, lastModified);
+                    onDownloaded(cached.ratings);
+                    return;
+                }
+                if (statusCode != 200 || parser->addData(reply->readAll()) != SeventeenLandsParser::Finished || rtgsList->isEmpty()) {
+                    onFailed();
+                    return;
+                }
+                m_ratingsCache.store(cacheKey, *rtgsList, etag, lastModified);
+                onDownloaded(*rtgsList);
+            });
+}
+
+void Worker::on17LRatingsDownloaded(const QString &set, const SeventeenTable &ratings)
+{
+    --m_SLrequestOutstanding;
+    emit downloaded17LRatings(set, ratings);
+    if (m_SLrequestOutstanding == 0)
+        emit downloadedAll17LRatings();
+    emit download17LRatingsProgress(m_SLrequestOutstanding);
+}
+
+void Worker::on17LRatingsFailed()
+{
+    --m_SLrequestOutstanding;
+    emit failed17LRatings();
+}
+
+void Worker::configureRatingsCache(qint64 maxAge, qint64 frozenMaxAge, qint64 sizeBudget)
+{
+    m_ratingsCache.setMaxAge(maxAge);
+    m_ratingsCache.setFrozenMaxAge(frozenMaxAge);
+    m_ratingsCache.setSizeBudget(sizeBudget);
+}
+
+void Worker::resumeUploads()
+{
+    uploadRatings(QVector<MtgahCard>());
+}
+
+void Worker::setUploadWindow(int window)
+{
+    m_uploadEngine->setWindow(window);
+    const QString host = m_requestFactory.endpoints().baseUrl(Endpoints::MtgaHelper).host();
+    RequestScheduler::HostPolicy policy = m_scheduler->hostPolicy(host);
+    policy.maxInFlight = m_uploadEngine->window();
+    policy.burst = std::max(policy.burst, double(policy.maxInFlight));
+    m_scheduler->setHostPolicy(host, policy);
+}
+
+void Worker::uploadRatings(const QVector<MtgahCard> &cards)
+{
+    // what a previous session left unacknowledged goes out again, superseded by the new value of the same card
+    QVector<MtgahCard> uploads = cards;
+    if (m_uploadEngine->outstanding() == 0 && m_uploadJournal.pendingCount() > 0) {
+        QSet<int> newIds;
+        for (const MtgahCard &card : cards)
+            newIds.insert(card.id_arena);
+        const QVector<MtgahCard> pendingCards = m_uploadJournal.pending();
+        for (const MtgahCard &card : pendingCards) {
+            if (!newIds.contains(card.id_arena))
+                uploads.append(card);
         }
-        emit ratingUploaded(currCard.name);
-        if (m_MTGAHrequestQueue.size() + m_MTGAHrequestOutstanding == 0)
+    }
+    if (uploads.isEmpty()) {
+        if (m_uploadEngine->outstanding() == 0)
             emit allRatingsUploaded();
-        emit ratingsUploadProgress(m_MTGAHrequestQueue.size() + m_MTGAHrequestOutstanding);
-    });
+        return;
+    }
+    m_uploadJournal.addPending(uploads);
+    m_uploadEngine->setRequest(m_requestFactory.jsonRequest(Endpoints::MtgaHelper, QStringLiteral("/api/User/CustomDraftRating")));
+    m_uploadEngine->enqueue(uploads);
+    emit ratingsUploadMaxProgress(m_uploadEngine->outstanding());
 }
@@ -13,34 +13,53 @@
 
 #ifndef WORKER_H
 #define WORKER_H
+#include "connectionstats.h"
+#include "endpoints.h"
 #include "mtgahcard.h"
+#include "ratingsstore.h"
+#include "requestfactory.h"
+#include "requestscheduler.h"
 #include "seventeencard.h"
-#include <QMultiHash>
+#include "seventeenlandscache.h"
+#include "sessionsnapshot.h"
+#include "seventeentable.h"
+#include "uploadjournal.h"
 #include <QNetworkRequest>
 #include <QObject>
 #include <QSet>
+#include <functional>
 class QNetworkAccessManager;
 
+class UploadEngine;
 class Worker : public QObject
 {
     Q_OBJECT
     Q_DISABLE_COPY_MOVE(Worker)
 public:
     explicit Worker(QObject *parent = nullptr);
-    QMultiHash<QString, MtgahCard> *ratingsTemplate();
+    // only safe from the thread the worker lives in
+    const ConnectionStatsMap &connectionStats() const;
 public slots:
+    // shows what the last run downloaded and restores its session, the caller still revalidates the sets and the template
+    void loadSnapshot();
     void tryLogin(const QString &userName, const QString &password);
     void logOut();
     void downloadSetsMTGAH();
     void downloadSetsScryfall();
     void getCustomRatingTemplate();
     void get17LRatings(const QStringList &sets, const QString &format);
-    void uploadRatings(const QStringList &sets);
-private slots:
-    void processSLrequestQueue();
-    void processMTGAHrequestQueue();
+    void get17LCube(const QStringList &sets, const QStringList &formats, const QStringList &colorFilters);
+    void uploadRatings(const QVector<MtgahCard> &cards);
+    void resumeUploads();
+    void setUploadWindow(int window);
+    void setEndpoints(const Endpoints &endpoints);
+    void prewarmConnections();
+    void setRequestPolicy(const QString &host, const RequestScheduler::HostPolicy &policy);
+    void configureRatingsCache(qint64 maxAge, qint64 frozenMaxAge, qint64 sizeBudget);
 signals:
     void loggedIn();
+    void sessionRestored(const QString &userName);
+    void sessionExpired();
     void loginFalied();
     void loggedOut();
     void logoutFailed();
@@ -48,25 +67,55 @@ signals:
     void setsMTGAH(const QStringList &sets);
     void downloadSetsScryfallFailed();
     void customRatingTemplateFailed();
-    void customRatingTemplate(const QMultiHash<QString, MtgahCard> &sets);
+    void customRatingTemplate(const RatingsStore &ratings);
+    // the server sent the template already emitted
+    void customRatingTemplateUnchanged();
     void setsScryfall(const QHash<QString, QString> &sets);
     void failed17LRatings();
     void downloadedAll17LRatings();
     void download17LRatingsProgress(int progress);
     void allRatingsUploaded();
-    void ratingUploaded(const QString &card);
+    void ratingUploaded(const MtgahCard &card);
     void ratingsUploadMaxProgress(int progress);
     void ratingsUploadProgress(int progress);
     void failedUploadRating(const MtgahCard &card);
-    void downloaded17LRatings(const QString &set, const QSet<SeventeenCard> &ratings);
+    void pendingUploadsFound(int count);
+    void setRatingsUploaded(const QString &set, int uploaded, int failed);
+    void ratingsUploadRate(double cardsPerSecond);
+    void downloaded17LRatings(const QString &set, const SeventeenTable &ratings);
+    void downloaded17LSlice(const QString &set, const QString &format, const QString &colors, const SeventeenTable &ratings);
+    void failed17LSlice(const QString &set, const QString &format, const QString &colors);
+    void download17LCubeProgress(int remaining);
+    void downloadedAll17LCube();
 
 private:
-    QList<std::pair<QString, QNetworkRequest>> m_SLrequestQueue;
-    QList<std::pair<MtgahCard, QNetworkRequest>> m_MTGAHrequestQueue;
-    QMultiHash<QString, MtgahCard> m_ratingsTemplate;
+    void on17LRatingsDownloaded(const QString &set, const SeventeenTable &ratings);
+    void on17LRatingsFailed();
+    void on17LSliceCompleted();
+    typedef std::function<void(const SeventeenTable &)> RatingsHandler;
+    void fetch17LRatings(const QString &set, const QString &format, const QString &colors, const RatingsHandler &onDownloaded,
+                         const std::function<void()> &onFailed);
+    void applyDefaultPolicies();
+    void confirmSession();
+    void expireSession();
+    void saveSnapshot();
+    SeventeenLandsCache m_ratingsCache;
     QNetworkAccessManager *m_nam;
+    SessionCookieJar *m_cookieJar;
+    RequestScheduler *m_scheduler;
+    ConnectionStats *m_connectionStats;
+    UploadEngine *m_uploadEngine;
+    RequestFactory m_requestFactory;
+    UploadJournal m_uploadJournal;
+    SessionSnapshot m_snapshot;
+    QString m_userName;
+    // hash of the template reply last emitted, an identical reply is not parsed again
+    QByteArray m_templateHash;
+    bool m_snapshotEnabled;
+    // the session comes from the snapshot and the server did not accept it yet
+    bool m_restoredSession;
     int m_SLrequestOutstanding;
-    int m_MTGAHrequestOutstanding;
+    int m_cubeRequestOutstanding;
 };
 
 #endif
@@ -0,0 +1,53 @@
+#include "standinserver.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <cstdio>
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("17HelperStandIn"));
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Local stand-in for the services used by 17Helper.\n"
+                                                    "Point the application to it with SEVENTEENHELPER_BASE_URL=http://127.0.0.1:<port>"));
+    parser.addHelpOption();
+    const QCommandLineOption portOption(QStringLiteral("port"), QStringLiteral("Port to listen on."), QStringLiteral("port"),
+                                        QStringLiteral("8642"));
+    const QCommandLineOption fixturesOption(QStringLiteral("fixtures"), QStringLiteral("Directory of the recorded replies."), QStringLiteral("dir"),
+                                            QStringLiteral("fixtures"));
+    const QCommandLineOption recordOption(QStringLiteral("record"),
+                                          QStringLiteral("Forward the requests to the real services and record the replies."));
+    const QCommandLineOption latencyOption(QStringLiteral("latency"), QStringLiteral("Delay of every reply in milliseconds."), QStringLiteral("ms"),
+                                           QStringLiteral("0"));
+    const QCommandLineOption bandwidthOption(QStringLiteral("bandwidth"), QStringLiteral("Cap of every reply in bytes per second, 0 is unlimited."),
+                                             QStringLiteral("bytes"), QStringLiteral("0"));
+    const QCommandLineOption rateLimitOption(QStringLiteral("rate-limit"), QStringLiteral("Probability of answering 429."), QStringLiteral("p"),
+                                             QStringLiteral("0"));
+    const QCommandLineOption retryAfterOption(QStringLiteral("retry-after"), QStringLiteral("Retry-After of the 429 replies in seconds."),
+                                              QStringLiteral("s"), QStringLiteral("1"));
+    const QCommandLineOption dropOption(QStringLiteral("drop"), QStringLiteral("Probability of closing the connection without replying."),
+                                        QStringLiteral("p"), QStringLiteral("0"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed of the fault injection."), QStringLiteral("seed"),
+                                        QStringLiteral("1"));
+    parser.addOptions(
+            {portOption, fixturesOption, recordOption, latencyOption, bandwidthOption, rateLimitOption, retryAfterOption, dropOption, seedOption});
+    parser.process(app);
+
+    FaultSettings faults;
+    faults.latency = parser.value(latencyOption).toInt();
+    faults.bytesPerSecond = parser.value(bandwidthOption).toLongLong();
+    faults.rateLimitProbability = parser.value(rateLimitOption).toDouble();
+    faults.retryAfter = parser.value(retryAfterOption).toInt();
+    faults.dropProbability = parser.value(dropOption).toDouble();
+    StandInServer server(parser.value(fixturesOption));
+    server.setFaults(faults);
+    server.setSeed(parser.value(seedOption).toUInt());
+    server.setRecording(parser.isSet(recordOption));
+    if (!server.listen(QHostAddress::LocalHost, parser.value(portOption).toUShort())) {
+        std::fprintf(stderr, "%s\n", qPrintable(server.errorString()));
+        return 1;
+    }
+    std::printf("Listening on http://127.0.0.1:%u\n", unsigned(server.serverPort()));
+    std::fflush(stdout);
+    return app.exec();
+}
@@ -0,0 +1,169 @@
+#include "standinconnection.h"
+#include <QTcpSocket>
+#include <QTimer>
+namespace {
+const int shapingInterval = 50;
+const int maxHeaderSize = 64 * 1024;
+
+QByteArray reasonPhrase(int status)
+{
+    switch (status) {
+    case 200:
+        return QByteArrayLiteral("OK");
+    case 304:
+        return QByteArrayLiteral("Not Modified");
+    case 400:
+        return QByteArrayLiteral("Bad Request");
+    case 404:
+        return QByteArrayLiteral("Not Found");
+    case 429:
+        return QByteArrayLiteral("Too Many Requests");
+    case 502:
+        return QByteArrayLiteral("Bad Gateway");
+    case 503:
+        return QByteArrayLiteral("Service Unavailable");
+    default:
+        return QByteArrayLiteral("Status");
+    }
+}
+}
+
+QByteArray HttpRequest::header(const QByteArray &name) const
+{
+    for (const QPair<QByteArray, QByteArray> &headerPair : headers) {
+        if (headerPair.first.compare(name, Qt::CaseInsensitive) == 0)
+            return headerPair.second;
+    }
+    return QByteArray();
+}
+
+HttpResponse::HttpResponse()
+    : status(200)
+{ }
+
+HttpResponse::HttpResponse(int statusCode, const QByteArray &body)
+    : status(statusCode)
+    , body(body)
+{ }
+
+StandInConnection::StandInConnection(QTcpSocket *socket, QObject *parent)
+    : QObject(parent)
+    , m_socket(socket)
+    , m_shapingTimer(new QTimer(this))
+    , m_bodyWritten(0)
+    , m_bytesPerSecond(0)
+    , m_busy(false)
+    , m_closeAfterResponse(false)
+{
+    m_socket->setParent(this);
+    m_shapingTimer->setInterval(shapingInterval);
+    connect(m_shapingTimer, &QTimer::timeout, this, &StandInConnection::writeBodySlice);
+    connect(m_socket, &QTcpSocket::readyRead, this, &StandInConnection::onReadyRead);
+    connect(m_socket, &QTcpSocket::disconnected, this, &QObject::deleteLater);
+}
+
+void StandInConnection::onReadyRead()
+{
+    m_buffer.append(m_socket->readAll());
+    processBuffer();
+}
+
+void StandInConnection::processBuffer()
+{
+    if (m_busy)
+        return;
+    const int headerEnd = m_buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (m_buffer.size() > maxHeaderSize)
+            drop();
+        return;
+    }
+    const QList<QByteArray> lines = m_buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() != 3) {
+        drop();
+        return;
+    }
+    HttpRequest request;
+    request.method = requestLine.at(0).toUpper();
+    request.url = QUrl::fromEncoded(requestLine.at(1));
+    for (int i = 1; i < lines.size(); ++i) {
+        const int colon = lines.at(i).indexOf(':');
+        if (colon > 0)
+            request.headers.append(qMakePair(lines.at(i).left(colon).trimmed(), lines.at(i).mid(colon + 1).trimmed()));
+    }
+    const int contentLength = request.header(QByteArrayLiteral("Content-Length")).toInt();
+    if (m_buffer.size() < headerEnd + 4 + contentLength)
+        return;
+    request.body = m_buffer.mid(headerEnd + 4, contentLength);
+    m_buffer.remove(0, headerEnd + 4 + contentLength);
+    m_closeAfterResponse = request.header(QByteArrayLiteral("Connection")).compare(QByteArrayLiteral("close"), Qt::CaseInsensitive) == 0
+            || requestLine.at(2) == QByteArrayLiteral("HTTP/1.0");
+    m_busy = true;
+    emit requestReceived(request);
+}
+
+void StandInConnection::respond(const HttpResponse &response, int latency, qint64 bytesPerSecond)
+{
+    Q_ASSERT(m_busy);
+    m_response = response;
+    m_bodyWritten = 0;
+    m_bytesPerSecond = bytesPerSecond;
+    if (latency > 0)
+        QTimer::singleShot(latency, this, &StandInConnection::writeHeaders);
+    else
+        writeHeaders();
+}
+
+void StandInConnection::writeHeaders()
+{
+    QByteArray head = QByteArrayLiteral("HTTP/1.1 ") + QByteArray::number(m_response.status) + ' ' + reasonPhrase(m_response.status) + "\r\n";
+    const HttpHeaders &responseHeaders = m_response.headers;
+    for (const QPair<QByteArray, QByteArray> &headerPair : responseHeaders)
+        head += headerPair.first + ": " + headerPair.second + "\r\n";
+    head += QByteArrayLiteral("Content-Length: ") + QByteArray::number(m_response.body.size()) + "\r\n";
+    head += m_closeAfterResponse ? QByteArrayLiteral("Connection: close\r\n\r\n") : QByteArrayLiteral("Connection: keep-alive\r\n\r\n");
+    m_socket->write(head);
+    emit bytesSent(head.size());
+    if (m_bytesPerSecond <= 0) {
+        m_socket->write(m_response.body);
+        emit bytesSent(m_response.body.size());
+        finishResponse();
+        return;
+    }
+    writeBodySlice();
+    if (m_busy)
+        m_shapingTimer->start();
+}
+
+void StandInConnection::writeBodySlice()
+{
+    const qint64 slice = qMax<qint64>(1, m_bytesPerSecond * shapingInterval / 1000);
+    const qint64 toWrite = qMin(slice, qint64(m_response.body.size()) - m_bodyWritten);
+    m_socket->write(m_response.body.constData() + m_bodyWritten, toWrite);
+    m_bodyWritten += toWrite;
+    emit bytesSent(toWrite);
+    if (m_bodyWritten >= m_response.body.size()) {
+        m_shapingTimer->stop();
+        finishResponse();
+    }
+}
+
+void StandInConnection::finishResponse()
+{
+    m_busy = false;
+    m_response = HttpResponse();
+    if (m_closeAfterResponse) {
+        m_socket->disconnectFromHost();
+        return;
+    }
+    processBuffer();
+}
+
+void StandInConnection::drop()
+{
+    m_shapingTimer->stop();
+    m_busy = false;
+    m_socket->abort();
+    deleteLater();
+}
@@ -0,0 +1,70 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef STANDINCONNECTION_H
+#define STANDINCONNECTION_H
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QUrl>
+class QTcpSocket;
+class QTimer;
+typedef QList<QPair<QByteArray, QByteArray>> HttpHeaders;
+struct HttpRequest
+{
+    QByteArray method;
+    QUrl url;
+    HttpHeaders headers;
+    QByteArray body;
+    QByteArray header(const QByteArray &name) const;
+};
+struct HttpResponse
+{
+    HttpResponse();
+    explicit HttpResponse(int statusCode, const QByteArray &body = QByteArray());
+    int status;
+    HttpHeaders headers;
+    QByteArray body;
+};
+// HTTP/1.1 server side of a single keep-alive connection. Requests are handled one at a time,
+// the response can be delayed and its body throttled to emulate slow links
+class StandInConnection : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(StandInConnection)
+public:
+    explicit StandInConnection(QTcpSocket *socket, QObject *parent = nullptr);
+    void respond(const HttpResponse &response, int latency, qint64 bytesPerSecond);
+    void drop();
+signals:
+    void requestReceived(const HttpRequest &request);
+    void bytesSent(qint64 bytes);
+
+private:
+    void onReadyRead();
+    void processBuffer();
+    void writeHeaders();
+    void writeBodySlice();
+    void finishResponse();
+    QTcpSocket *m_socket;
+    QTimer *m_shapingTimer;
+    QByteArray m_buffer;
+    HttpResponse m_response;
+    qint64 m_bodyWritten;
+    qint64 m_bytesPerSecond;
+    bool m_busy;
+    bool m_closeAfterResponse;
+};
+#endif
@@ -0,0 +1,305 @@
+#include "standinserver.h"
+#include "endpoints.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QTcpSocket>
+#include <QUrlQuery>
+#include <algorithm>
+namespace {
+const QLatin1String controlPrefix("/_standin/");
+
+bool isHopHeader(const QByteArray &name)
+{
+    static const QByteArray hopHeaders[] = {QByteArrayLiteral("host"), QByteArrayLiteral("connection"), QByteArrayLiteral("keep-alive"),
+                                            QByteArrayLiteral("content-length"), QByteArrayLiteral("accept-encoding"),
+                                            QByteArrayLiteral("transfer-encoding"), QByteArrayLiteral("content-encoding")};
+    const QByteArray lowerName = name.toLower();
+    return std::find(std::begin(hopHeaders), std::end(hopHeaders), lowerName) != std::end(hopHeaders);
+}
+
+// the cookies of the real services would be rejected by the client for a different host
+QByteArray localCookie(const QByteArray &setCookie)
+{
+    QList<QByteArray> parts = setCookie.split(';');
+    for (auto i = parts.begin(); i != parts.end();) {
+        const QByteArray attribute = i->trimmed().toLower();
+        if (attribute.startsWith("domain=") || attribute == "secure")
+            i = parts.erase(i);
+        else
+            ++i;
+    }
+    return parts.join(';');
+}
+
+Endpoints::Service serviceForPath(const QString &path)
+{
+    if (path.startsWith(QLatin1String("/card_ratings")))
+        return Endpoints::SeventeenLands;
+    if (path == QLatin1String("/sets") || path.startsWith(QLatin1String("/sets/")) || path.startsWith(QLatin1String("/cards")))
+        return Endpoints::Scryfall;
+    return Endpoints::MtgaHelper;
+}
+}
+
+FaultSettings::FaultSettings()
+    : latency(0)
+    , bytesPerSecond(0)
+    , rateLimitProbability(0.0)
+    , retryAfter(1)
+    , dropProbability(0.0)
+{ }
+
+StandInServer::Stats::Stats()
+    : requests(0)
+    , uploads(0)
+    , rateLimited(0)
+    , dropped(0)
+    , notFound(0)
+    , bytesSent(0)
+{ }
+
+StandInServer::StandInServer(const QString &fixturesDir, QObject *parent)
+    : QTcpServer(parent)
+    , m_fixturesDir(fixturesDir)
+    , m_random(1)
+    , m_upstream(new QNetworkAccessManager(this))
+    , m_recording(false)
+{ }
+
+void StandInServer::setRecording(bool recording)
+{
+    m_recording = recording;
+    if (m_recording)
+        m_fixturesDir.mkpath(QStringLiteral("."));
+}
+
+void StandInServer::setFaults(const FaultSettings &faults)
+{
+    m_faults = faults;
+}
+
+void StandInServer::setSeed(quint32 seed)
+{
+    m_random.seed(seed);
+}
+
+QString StandInServer::fixtureKey(const HttpRequest &request)
+{
+    // credentials never end up in the fixture names
+    QList<QPair<QString, QString>> queryItems = QUrlQuery(request.url).queryItems(QUrl::FullyDecoded);
+    for (auto i = queryItems.begin(); i != queryItems.end();) {
+        if (i->first == QLatin1String("email") || i->first == QLatin1String("password"))
+            i = queryItems.erase(i);
+        else
+            ++i;
+    }
+    std::sort(queryItems.begin(), queryItems.end());
+    QString result = QString::fromLatin1(request.method.toLower()) + request.url.path();
+    for (const QPair<QString, QString> &item : queryItems)
+        result += QLatin1Char('_') + item.first + QLatin1Char('-') + item.second;
+    static const QRegularExpression unsafeChars(QStringLiteral("[^A-Za-z0-9_\\-]+"));
+    result.replace(unsafeChars, QStringLiteral("_"));
+    if (result.size() > 120)
+        result = result.left(80) + QLatin1Char('_')
+                + QString::fromLatin1(QCryptographicHash::hash(result.toUtf8(), QCryptographicHash::Sha1).toHex().left(16));
+    return result;
+}
+
+void StandInServer::incomingConnection(qintptr socketDescriptor)
+{
+    QTcpSocket *socket = new QTcpSocket;
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        delete socket;
+        return;
+    }
+    StandInConnection *connection = new StandInConnection(socket, this);
+    connect(connection, &StandInConnection::requestReceived, this,
+            [this, connection](const HttpRequest &request) { onRequest(connection, request); });
+    connect(connection, &StandInConnection::bytesSent, this, [this](qint64 bytes) { m_stats.bytesSent += bytes; });
+}
+
+void StandInServer::onRequest(StandInConnection *connection, const HttpRequest &request)
+{
+    if (request.url.path().startsWith(controlPrefix)) {
+        handleControl(connection, request);
+        return;
+    }
+    ++m_stats.requests;
+    if (m_faults.dropProbability > 0.0 && m_random.generateDouble() < m_faults.dropProbability) {
+        ++m_stats.dropped;
+        connection->drop();
+        return;
+    }
+    if (m_faults.rateLimitProbability > 0.0 && m_random.generateDouble() < m_faults.rateLimitProbability) {
+        ++m_stats.rateLimited;
+        HttpResponse response(429);
+        response.headers.append(qMakePair(QByteArrayLiteral("Retry-After"), QByteArray::number(m_faults.retryAfter)));
+        respond(connection, response);
+        return;
+    }
+    // uploads are never forwarded, not even while recording
+    if (request.method == "PUT" || request.method == "POST") {
+        ++m_stats.uploads;
+        HttpResponse response(200, QByteArrayLiteral("{}"));
+        response.headers.append(qMakePair(QByteArrayLiteral("Content-Type"), QByteArrayLiteral("application/json")));
+        respond(connection, response);
+        return;
+    }
+    if (m_recording) {
+        record(connection, request);
+        return;
+    }
+    HttpResponse response;
+    if (!loadFixture(fixtureKey(request), response)) {
+        ++m_stats.notFound;
+        response = HttpResponse(404, fixtureKey(request).toUtf8());
+    }
+    respond(connection, response);
+}
+
+void StandInServer::handleControl(StandInConnection *connection, const HttpRequest &request)
+{
+    const QString command = request.url.path().mid(controlPrefix.size());
+    const QUrlQuery query(request.url);
+    if (command == QLatin1String("faults")) {
+        bool ok = false;
+        int intValue = query.queryItemValue(QStringLiteral("latency")).toInt(&ok);
+        if (ok)
+            m_faults.latency = intValue;
+        const qint64 bandwidth = query.queryItemValue(QStringLiteral("bandwidth")).toLongLong(&ok);
+        if (ok)
+            m_faults.bytesPerSecond = bandwidth;
+        double doubleValue = query.queryItemValue(QStringLiteral("ratelimit")).toDouble(&ok);
+        if (ok)
+            m_faults.rateLimitProbability = doubleValue;
+        intValue = query.queryItemValue(QStringLiteral("retryafter")).toInt(&ok);
+        if (ok)
+            m_faults.retryAfter = intValue;
+        doubleValue = query.queryItemValue(QStringLiteral("drop")).toDouble(&ok);
+        if (ok)
+            m_faults.dropProbability = doubleValue;
+    } else if (command != QLatin1String("stats")) {
+        connection->respond(HttpResponse(404), 0, 0);
+        return;
+    }
+    QJsonObject faultsObject;
+    faultsObject[QLatin1String("latency")] = m_faults.latency;
+    faultsObject[QLatin1String("bandwidth")] = m_faults.bytesPerSecond;
+    faultsObject[QLatin1String("ratelimit")] = m_faults.rateLimitProbability;
+    faultsObject[QLatin1String("retryafter")] = m_faults.retryAfter;
+    faultsObject[QLatin1String("drop")] = m_faults.dropProbability;
+    QJsonObject statsObject;
+    statsObject[QLatin1String("requests")] = m_stats.requests;
+    statsObject[QLatin1String("uploads")] = m_stats.uploads;
+    statsObject[QLatin1String("rateLimited")] = m_stats.rateLimited;
+    statsObject[QLatin1String("dropped")] = m_stats.dropped;
+    statsObject[QLatin1String("notFound")] = m_stats.notFound;
+    statsObject[QLatin1String("bytesSent")] = m_stats.bytesSent;
+    statsObject[QLatin1String("faults")] = faultsObject;
+    HttpResponse response(200, QJsonDocument(statsObject).toJson(QJsonDocument::Compact));
+    response.headers.append(qMakePair(QByteArrayLiteral("Content-Type"), QByteArrayLiteral("application/json")));
+    connection->respond(response, 0, 0);
+}
+
+void StandInServer::record(StandInConnection *connection, const HttpRequest &request)
+{
+    QUrl upstreamUrl = Endpoints::defaultBaseUrl(serviceForPath(request.url.path()));
+    upstreamUrl.setPath(request.url.path());
+    upstreamUrl.setQuery(request.url.query(QUrl::FullyEncoded), QUrl::StrictMode);
+    QNetworkRequest upstreamRequest(upstreamUrl);
+    for (const QPair<QByteArray, QByteArray> &headerPair : request.headers) {
+        // conditional headers would record empty 304 bodies
+        const QByteArray lowerName = headerPair.first.toLower();
+        if (!isHopHeader(headerPair.first) && lowerName != "if-none-match" && lowerName != "if-modified-since")
+            upstreamRequest.setRawHeader(headerPair.first, headerPair.second);
+    }
+    QNetworkReply *reply = m_upstream->sendCustomRequest(upstreamRequest, request.method, request.body);
+    connect(connection, &QObject::destroyed, reply, &QNetworkReply::abort);
+    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+    connect(reply, &QNetworkReply::finished, connection, [this, connection, reply, request]() {
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status == 0) {
+            connection->respond(HttpResponse(502, reply->errorString().toUtf8()), 0, 0);
+            return;
+        }
+        HttpResponse fixture(status, reply->readAll());
+        HttpResponse relayed = fixture;
+        for (const QNetworkReply::RawHeaderPair &headerPair : reply->rawHeaderPairs()) {
+            if (isHopHeader(headerPair.first))
+                continue;
+            if (headerPair.first.compare(QByteArrayLiteral("Set-Cookie"), Qt::CaseInsensitive) == 0) {
+                // QNetworkReply joins multiple cookies with new lines
+                for (const QByteArray &cookie : headerPair.second.split('\n'))
+                    relayed.headers.append(qMakePair(headerPair.first, localCookie(cookie)));
+                continue;
+            }
+            fixture.headers.append(headerPair);
+            relayed.headers.append(headerPair);
+        }
+        if (status == 200)
+            saveFixture(fixtureKey(request), fixture);
+        connection->respond(relayed, 0, 0);
+    });
+}
+
+bool StandInServer::loadFixture(const QString &key, HttpResponse &response)
+{
+    const auto cached = m_fixtures.constFind(key);
+    if (cached != m_fixtures.constEnd()) {
+        response = cached.value();
+        return true;
+    }
+    QFile bodyFile(m_fixturesDir.filePath(key + QLatin1String(".body")));
+    if (!bodyFile.open(QIODevice::ReadOnly))
+        return false;
+    response = HttpResponse(200, bodyFile.readAll());
+    QFile metaFile(m_fixturesDir.filePath(key + QLatin1String(".json")));
+    if (metaFile.open(QIODevice::ReadOnly)) {
+        const QJsonObject metaObject = QJsonDocument::fromJson(metaFile.readAll()).object();
+        response.status = metaObject[QLatin1String("status")].toInt(200);
+        const QJsonArray headersArray = metaObject[QLatin1String("headers")].toArray();
+        for (const QJsonValue &headerValue : headersArray) {
+            const QJsonArray headerPair = headerValue.toArray();
+            response.headers.append(qMakePair(headerPair.at(0).toString().toUtf8(), headerPair.at(1).toString().toUtf8()));
+        }
+    } else {
+        response.headers.append(qMakePair(QByteArrayLiteral("Content-Type"), QByteArrayLiteral("application/json")));
+    }
+    m_fixtures.insert(key, response);
+    return true;
+}
+
+void StandInServer::saveFixture(const QString &key, const HttpResponse &response)
+{
+    QSaveFile bodyFile(m_fixturesDir.filePath(key + QLatin1String(".body")));
+    if (!bodyFile.open(QIODevice::WriteOnly))
+        return;
+    bodyFile.write(response.body);
+    if (!bodyFile.commit())
+        return;
+    QJsonArray headersArray;
+    for (const QPair<QByteArray, QByteArray> &headerPair : response.headers)
+        headersArray.append(QJsonArray{QString::fromUtf8(headerPair.first), QString::fromUtf8(headerPair.second)});
+    QJsonObject metaObject;
+    metaObject[QLatin1String("status")] = response.status;
+    metaObject[QLatin1String("headers")] = headersArray;
+    QSaveFile metaFile(m_fixturesDir.filePath(key + QLatin1String(".json")));
+    if (!metaFile.open(QIODevice::WriteOnly))
+        return;
+    metaFile.write(QJsonDocument(metaObject).toJson());
+    metaFile.commit();
+    m_fixtures.insert(key, response);
+}
+
+void StandInServer::respond(StandInConnection *connection, const HttpResponse &response)
+{
+    connection->respond(response, m_faults.latency, m_faults.bytesPerSecond);
+}
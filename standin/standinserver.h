@@ -0,0 +1,75 @@
+/****************************************************************************\
+   Copyright 2021 Luca Beldi
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+\****************************************************************************/
+
+
+#ifndef STANDINSERVER_H
+#define STANDINSERVER_H
+#include "standinconnection.h"
+#include <QDir>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QTcpServer>
+class QNetworkAccessManager;
+struct FaultSettings
+{
+    FaultSettings();
+    int latency;
+    qint64 bytesPerSecond;
+    double rateLimitProbability;
+    int retryAfter;
+    double dropProbability;
+};
+// Local replacement for MTGAHelper, Scryfall and 17Lands.
+// Replays the fixtures stored in a directory (or records them from the real services),
+// accepts rating uploads and injects latency, bandwidth caps, 429 replies and dropped connections.
+// GET /_standin/stats reports the counters, GET /_standin/faults?latency=&bandwidth=&ratelimit=&retryafter=&drop= changes the faults live
+class StandInServer : public QTcpServer
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(StandInServer)
+public:
+    explicit StandInServer(const QString &fixturesDir, QObject *parent = nullptr);
+    void setRecording(bool recording);
+    void setFaults(const FaultSettings &faults);
+    void setSeed(quint32 seed);
+    static QString fixtureKey(const HttpRequest &request);
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+
+private:
+    struct Stats
+    {
+        Stats();
+        qint64 requests;
+        qint64 uploads;
+        qint64 rateLimited;
+        qint64 dropped;
+        qint64 notFound;
+        qint64 bytesSent;
+    };
+    void onRequest(StandInConnection *connection, const HttpRequest &request);
+    void handleControl(StandInConnection *connection, const HttpRequest &request);
+    void record(StandInConnection *connection, const HttpRequest &request);
+    bool loadFixture(const QString &key, HttpResponse &response);
+    void saveFixture(const QString &key, const HttpResponse &response);
+    void respond(StandInConnection *connection, const HttpResponse &response);
+    QDir m_fixturesDir;
+    QHash<QString, HttpResponse> m_fixtures;
+    FaultSettings m_faults;
+    Stats m_stats;
+    QRandomGenerator m_random;
+    QNetworkAccessManager *m_upstream;
+    bool m_recording;
+};
+#endif